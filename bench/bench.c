@@ -0,0 +1,267 @@
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define BENCH_DEFAULT_MIN_TIME 0.2
+
+volatile uint64_t bench_sink;
+
+static uint64_t bench_alloc_count;
+static uint64_t bench_rand_state = 0x9e3779b97f4a7c15ULL;
+static bool bench_header_done;
+
+static void*
+bench_alloc(void *ctx, size_t size)
+{
+	(void)ctx;
+	bench_alloc_count++;
+
+	return malloc(size);
+}
+
+static void*
+bench_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+	(void)ctx;
+	(void)old_size;
+	bench_alloc_count++;
+
+	return realloc(ptr, new_size);
+}
+
+static void
+bench_free(void *ctx, void *ptr)
+{
+	(void)ctx;
+	free(ptr);
+}
+
+const slice_allocator_t bench_allocator = {
+	.alloc = bench_alloc,
+	.realloc = bench_realloc,
+	.free = bench_free,
+	.ctx = NULL,
+};
+
+uint64_t
+bench_allocs(void)
+{
+	return bench_alloc_count;
+}
+
+double
+bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+uint64_t
+bench_rand(void)
+{
+	uint64_t x = bench_rand_state;
+
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	bench_rand_state = x;
+
+	return x;
+}
+
+/**
+ * bench_match reports whether name is one of the comma separated entries
+ * of filter. A NULL filter matches everything.
+ */
+static bool
+bench_match(const char *filter, const char *name)
+{
+	size_t len = strlen(name);
+
+	if (filter == NULL) {
+		return true;
+	}
+
+	while (*filter != '\0') {
+		const char *end = strchr(filter, ',');
+		size_t n = end == NULL ? strlen(filter) : (size_t)(end - filter);
+
+		if (n == len && strncmp(filter, name, n) == 0) {
+			return true;
+		}
+		if (end == NULL) {
+			break;
+		}
+		filter = end + 1;
+	}
+
+	return false;
+}
+
+bool
+bench_enabled(const bench_config_t *cfg, const char *type, const char *op)
+{
+	return bench_match(cfg->type_filter, type) && bench_match(cfg->op_filter, op);
+}
+
+void
+bench_report(const bench_config_t *cfg, const bench_result_t *r)
+{
+	double ns_per_op = r->items == 0 ? 0 : r->ns / (double)r->items;
+	double bytes_per_sec = r->ns == 0 ? 0 : (double)r->bytes * 1e9 / r->ns;
+	double allocs_per_call = r->calls == 0 ? 0 : (double)r->allocs / (double)r->calls;
+
+	if (cfg->format == BENCH_FORMAT_JSON) {
+		printf("{\"type\":\"%s\",\"op\":\"%s\",\"n\":%llu,\"calls\":%llu,"
+		    "\"ns_per_op\":%.3f,\"bytes_per_sec\":%.0f,\"allocs_per_call\":%.3f}\n",
+		    r->type, r->op, (unsigned long long)r->n, (unsigned long long)r->calls,
+		    ns_per_op, bytes_per_sec, allocs_per_call);
+	} else {
+		if (!bench_header_done) {
+			printf("type,op,n,calls,ns_per_op,bytes_per_sec,allocs_per_call\n");
+			bench_header_done = true;
+		}
+		printf("%s,%s,%llu,%llu,%.3f,%.0f,%.3f\n",
+		    r->type, r->op, (unsigned long long)r->n, (unsigned long long)r->calls,
+		    ns_per_op, bytes_per_sec, allocs_per_call);
+	}
+	fflush(stdout);
+}
+
+/**
+ * bench_parse_sizes reads a comma separated list of sizes, each optionally
+ * suffixed with K, M or G.
+ */
+static int
+bench_parse_sizes(bench_config_t *cfg, const char *arg)
+{
+	cfg->sizes_len = 0;
+
+	while (*arg != '\0') {
+		char *end;
+		uint64_t n = strtoull(arg, &end, 10);
+
+		switch (*end) {
+		case 'k':
+		case 'K':
+			n *= 1000;
+			end++;
+			break;
+		case 'm':
+		case 'M':
+			n *= 1000000;
+			end++;
+			break;
+		case 'g':
+		case 'G':
+			n *= 1000000000;
+			end++;
+			break;
+		}
+		if (end == arg || n == 0 || (*end != ',' && *end != '\0') || cfg->sizes_len == BENCH_MAX_SIZES) {
+			return -1;
+		}
+		cfg->sizes[cfg->sizes_len++] = n;
+
+		arg = *end == ',' ? end + 1 : end;
+	}
+
+	return cfg->sizes_len == 0 ? -1 : 0;
+}
+
+static void
+bench_usage(const char *name)
+{
+	fprintf(stderr,
+	    "usage: %s [-n sizes] [-t min_time] [-f csv|json] [-T types] [-o ops]\n"
+	    "  -n  comma separated slice sizes, K, M and G suffixes allowed\n"
+	    "      (default 1K,10K,100K,1M,10M,100M)\n"
+	    "  -t  minimum seconds spent on each measurement (default %.1f)\n"
+	    "  -f  output format (default csv)\n"
+	    "  -T  comma separated slice types to run, e.g. int32_slice,string_slice\n"
+	    "  -o  comma separated operations to run, e.g. sort,contains\n",
+	    name, BENCH_DEFAULT_MIN_TIME);
+}
+
+int
+main(int argc, char **argv)
+{
+	static const uint64_t default_sizes[] = {
+		1000, 10000, 100000, 1000000, 10000000, 100000000,
+	};
+	bench_config_t cfg = {
+		.sizes_len = sizeof(default_sizes) / sizeof(default_sizes[0]),
+		.min_time = BENCH_DEFAULT_MIN_TIME,
+		.format = BENCH_FORMAT_CSV,
+	};
+
+	memcpy(cfg.sizes, default_sizes, sizeof(default_sizes));
+
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "-h") == 0) {
+			bench_usage(argv[0]);
+			return 0;
+		}
+		if (val == NULL) {
+			bench_usage(argv[0]);
+			return 1;
+		}
+		i++;
+
+		if (strcmp(arg, "-n") == 0) {
+			if (bench_parse_sizes(&cfg, val) != 0) {
+				bench_usage(argv[0]);
+				return 1;
+			}
+		} else if (strcmp(arg, "-t") == 0) {
+			cfg.min_time = strtod(val, NULL);
+		} else if (strcmp(arg, "-f") == 0) {
+			if (strcmp(val, "json") == 0) {
+				cfg.format = BENCH_FORMAT_JSON;
+			} else if (strcmp(val, "csv") == 0) {
+				cfg.format = BENCH_FORMAT_CSV;
+			} else {
+				bench_usage(argv[0]);
+				return 1;
+			}
+		} else if (strcmp(arg, "-T") == 0) {
+			cfg.type_filter = val;
+		} else if (strcmp(arg, "-o") == 0) {
+			cfg.op_filter = val;
+		} else {
+			bench_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	bench_int_slice(&cfg);
+	bench_int8_slice(&cfg);
+	bench_int16_slice(&cfg);
+	bench_int32_slice(&cfg);
+	bench_int64_slice(&cfg);
+	bench_uint_slice(&cfg);
+	bench_uint8_slice(&cfg);
+	bench_uint16_slice(&cfg);
+	bench_uint32_slice(&cfg);
+	bench_uint64_slice(&cfg);
+	bench_size_t_slice(&cfg);
+	bench_string_slice(&cfg);
+
+	return 0;
+}
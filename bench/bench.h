@@ -0,0 +1,134 @@
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../slice_allocator.h"
+
+#define BENCH_MAX_SIZES 16
+
+typedef enum {
+    BENCH_FORMAT_CSV = 0,
+    BENCH_FORMAT_JSON,
+} bench_format_t;
+
+/**
+ * bench_config_t holds the options given on the command line.
+ */
+typedef struct {
+    uint64_t sizes[BENCH_MAX_SIZES];
+    size_t sizes_len;
+    double min_time;
+    bench_format_t format;
+    const char *type_filter;
+    const char *op_filter;
+} bench_config_t;
+
+/**
+ * bench_result_t is one measurement: an operation run calls times on a
+ * slice of n items, taking ns nanoseconds in total, moving bytes bytes
+ * and making allocs calls into the allocator.
+ */
+typedef struct {
+    const char *type;
+    const char *op;
+    uint64_t n;
+    uint64_t calls;
+    uint64_t items;
+    double ns;
+    uint64_t bytes;
+    uint64_t allocs;
+} bench_result_t;
+
+/**
+ * bench_allocator forwards to the C library and counts every alloc and
+ * realloc so the allocations made by an operation can be reported.
+ */
+extern const slice_allocator_t bench_allocator;
+
+/**
+ * bench_allocs returns the number of allocations made through
+ * bench_allocator so far.
+ */
+uint64_t
+bench_allocs(void);
+
+/**
+ * bench_now returns a monotonic timestamp in nanoseconds.
+ */
+double
+bench_now(void);
+
+/**
+ * bench_rand returns the next value of a fixed seed xorshift generator so
+ * every run works on the same data.
+ */
+uint64_t
+bench_rand(void);
+
+/**
+ * bench_enabled reports whether the given type and operation pass the
+ * filters given on the command line.
+ */
+bool
+bench_enabled(const bench_config_t *cfg, const char *type, const char *op);
+
+/**
+ * bench_report prints a result in the configured format.
+ */
+void
+bench_report(const bench_config_t *cfg, const bench_result_t *r);
+
+/**
+ * bench_sink keeps the compiler from discarding results that are
+ * otherwise unused.
+ */
+extern volatile uint64_t bench_sink;
+
+/**
+ * BENCH_MEASURE repeats body until cfg->min_time seconds have been spent
+ * in it, timing only body and counting the allocations it makes. setup
+ * and teardown run untimed around every call. Each call is credited with
+ * call_items items and call_bytes bytes. The loop also gives up once four
+ * times min_time has passed in total, so an expensive setup can't stall a
+ * run. The totals are left in the bench_result_t r.
+ */
+#define BENCH_MEASURE(cfg, r, call_items, call_bytes, setup, body, teardown) \
+    do {                                                                     \
+        double bench_limit = (cfg)->min_time * 1e9;                          \
+        double bench_start = bench_now();                                    \
+        (r).calls = 0;                                                       \
+        (r).items = 0;                                                       \
+        (r).ns = 0;                                                          \
+        (r).bytes = 0;                                                       \
+        (r).allocs = 0;                                                      \
+        do {                                                                 \
+            setup;                                                           \
+            uint64_t bench_a = bench_allocs();                               \
+            double bench_t = bench_now();                                    \
+            body;                                                            \
+            (r).ns += bench_now() - bench_t;                                 \
+            (r).allocs += bench_allocs() - bench_a;                          \
+            teardown;                                                        \
+            (r).calls++;                                                     \
+            (r).items += (call_items);                                       \
+            (r).bytes += (call_bytes);                                       \
+        } while ((r).ns < bench_limit && bench_now() - bench_start < 4 * bench_limit); \
+    } while (0)
+
+void bench_int_slice(const bench_config_t *cfg);
+void bench_int8_slice(const bench_config_t *cfg);
+void bench_int16_slice(const bench_config_t *cfg);
+void bench_int32_slice(const bench_config_t *cfg);
+void bench_int64_slice(const bench_config_t *cfg);
+void bench_uint_slice(const bench_config_t *cfg);
+void bench_uint8_slice(const bench_config_t *cfg);
+void bench_uint16_slice(const bench_config_t *cfg);
+void bench_uint32_slice(const bench_config_t *cfg);
+void bench_uint64_slice(const bench_config_t *cfg);
+void bench_size_t_slice(const bench_config_t *cfg);
+void bench_string_slice(const bench_config_t *cfg);
+
+#endif /** end __BENCH_H */
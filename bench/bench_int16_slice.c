@@ -0,0 +1,6 @@
+#include "../int16_slice.h"
+
+#define BENCH_NAME int16_slice
+#define BENCH_T int16_t
+
+#include "bench_slice.h"
@@ -0,0 +1,6 @@
+#include "../int32_slice.h"
+
+#define BENCH_NAME int32_slice
+#define BENCH_T int32_t
+
+#include "bench_slice.h"
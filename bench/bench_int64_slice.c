@@ -0,0 +1,6 @@
+#include "../int64_slice.h"
+
+#define BENCH_NAME int64_slice
+#define BENCH_T int64_t
+
+#include "bench_slice.h"
@@ -0,0 +1,6 @@
+#include "../int8_slice.h"
+
+#define BENCH_NAME int8_slice
+#define BENCH_T int8_t
+
+#include "bench_slice.h"
@@ -0,0 +1,6 @@
+#include "../int_slice.h"
+
+#define BENCH_NAME int_slice
+#define BENCH_T int
+
+#include "bench_slice.h"
@@ -0,0 +1,6 @@
+#include "../size_t_slice.h"
+
+#define BENCH_NAME size_t_slice
+#define BENCH_T size_t
+
+#include "bench_slice.h"
@@ -0,0 +1,395 @@
+/**
+ * bench_slice.h is included once per numeric slice type with BENCH_NAME
+ * set to the type's prefix, e.g. int32_slice, and BENCH_T to its item
+ * type. It defines bench_<BENCH_NAME> running every operation over each
+ * configured size. Each type is built in its own file.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+#define BENCH_CAT_(a, b) a##b
+#define BENCH_CAT(a, b) BENCH_CAT_(a, b)
+#define BENCH_FN(suffix) BENCH_CAT(BENCH_NAME, suffix)
+#define BENCH_STR_(x) #x
+#define BENCH_STR(x) BENCH_STR_(x)
+
+#define BENCH_SLICE_T BENCH_FN(_t)
+
+/**
+ * BENCH_PROBE is the value searched for by contains and count. It's kept
+ * out of the random data so both always scan the whole slice.
+ */
+#define BENCH_PROBE ((BENCH_T)1)
+
+/**
+ * BENCH_PROBES is the number of lookups timed per call by the ops that
+ * search sorted or indexed data, each too quick to time on its own.
+ */
+#define BENCH_PROBES 1024
+
+static BENCH_SLICE_T*
+BENCH_FN(_bench_new)(const uint64_t cap)
+{
+	return BENCH_FN(_new_with_allocator)(cap, &bench_allocator);
+}
+
+static void
+BENCH_FN(_bench_sum)(const BENCH_T item, void *user_data)
+{
+	*(uint64_t*)user_data += (uint64_t)item;
+}
+
+static void
+BENCH_FN(_bench_sum_block)(const BENCH_T *items, const uint64_t n, void *user_data)
+{
+	uint64_t sum = 0;
+
+	for (uint64_t i = 0; i < n; i++) {
+		sum += (uint64_t)items[i];
+	}
+	*(uint64_t*)user_data += sum;
+}
+
+static bool
+BENCH_FN(_bench_even)(const BENCH_T item, void *user_data)
+{
+	(void)user_data;
+
+	return ((uint64_t)item & 1) == 0;
+}
+
+static void
+BENCH_FN(_bench_size)(const bench_config_t *cfg, const uint64_t n)
+{
+	const char *type = BENCH_STR(BENCH_NAME);
+	const uint64_t bytes = n * sizeof(BENCH_T);
+	bench_result_t r = {.type = type, .n = n};
+	BENCH_SLICE_T *s;
+	BENCH_SLICE_T *d = NULL;
+	BENCH_T *data;
+
+	data = malloc(sizeof(BENCH_T) * n);
+	if (data == NULL) {
+		return;
+	}
+	for (uint64_t i = 0; i < n; i++) {
+		data[i] = (BENCH_T)bench_rand();
+		if (data[i] == BENCH_PROBE) {
+			data[i] = (BENCH_T)(BENCH_PROBE + 1);
+		}
+	}
+
+	s = BENCH_FN(_new)(n);
+	if (s == NULL) {
+		free(data);
+		return;
+	}
+	BENCH_FN(_append_n)(s, data, n);
+
+	if (bench_enabled(cfg, type, r.op = "new_free")) {
+		BENCH_MEASURE(cfg, r, 1, bytes,
+		    (void)0,
+		    BENCH_FN(_free)(BENCH_FN(_bench_new)(n)),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "append_cold")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(0),
+		    for (uint64_t i = 0; i < n; i++) { BENCH_FN(_append)(d, data[i]); },
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "append_reserved")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(0); BENCH_FN(_reserve)(d, n),
+		    for (uint64_t i = 0; i < n; i++) { BENCH_FN(_append)(d, data[i]); },
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * concurrent_append is append_cold on a concurrent slice, from a single
+	 * thread, so it measures the atomic add and segment lookup.
+	 */
+	if (bench_enabled(cfg, type, r.op = "concurrent_append")) {
+		BENCH_FN(_concurrent_t) *c = NULL;
+
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    c = BENCH_FN(_concurrent_new_with_allocator)(0, &bench_allocator),
+		    for (uint64_t i = 0; i < n; i++) { BENCH_FN(_concurrent_append)(c, data[i]); },
+		    BENCH_FN(_concurrent_free)(c));
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * chunked_append is append_cold on a chunked slice, which never copies
+	 * its items when it grows, chunked_get reads them back.
+	 */
+	if (bench_enabled(cfg, type, r.op = "chunked_append")) {
+		BENCH_FN(_chunked_t) *c = NULL;
+
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    c = BENCH_FN(_chunked_new_with_allocator)(0, &bench_allocator),
+		    for (uint64_t i = 0; i < n; i++) { BENCH_FN(_chunked_append)(c, data[i]); },
+		    BENCH_FN(_chunked_free)(c));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "chunked_get")) {
+		BENCH_FN(_chunked_t) *c = BENCH_FN(_chunked_new_with_allocator)(n, &bench_allocator);
+
+		if (c != NULL) {
+			BENCH_FN(_chunked_append_n)(c, data, n);
+			BENCH_MEASURE(cfg, r, n, bytes,
+			    (void)0,
+			    uint64_t sum = 0; for (uint64_t i = 0; i < n; i++) { sum += (uint64_t)BENCH_FN(_chunked_get)(c, i); } bench_sink = sum,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+		BENCH_FN(_chunked_free)(c);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "get")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    uint64_t sum = 0; for (uint64_t i = 0; i < n; i++) { sum += (uint64_t)BENCH_FN(_get)(s, i); } bench_sink = sum,
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "contains")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    bench_sink = BENCH_FN(_contains)(s, BENCH_PROBE),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "count")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    bench_sink = BENCH_FN(_count)(s, BENCH_PROBE, NULL),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * the sorted ops look up BENCH_PROBES items of the data in a sorted
+	 * copy of it per call, which contains and count binary search.
+	 */
+	if (bench_enabled(cfg, type, "contains_sorted") || bench_enabled(cfg, type, "count_sorted")) {
+		d = BENCH_FN(_bench_new)(n);
+		BENCH_FN(_append_n)(d, data, n);
+		BENCH_FN(_sort)(d, NULL);
+
+		if (bench_enabled(cfg, type, r.op = "contains_sorted")) {
+			BENCH_MEASURE(cfg, r, BENCH_PROBES, BENCH_PROBES * sizeof(BENCH_T),
+			    (void)0,
+			    uint64_t hits = 0; for (uint64_t i = 0; i < BENCH_PROBES; i++) { hits += BENCH_FN(_contains)(d, data[(i * 7919) % n]); } bench_sink = hits,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+
+		if (bench_enabled(cfg, type, r.op = "count_sorted")) {
+			BENCH_MEASURE(cfg, r, BENCH_PROBES, BENCH_PROBES * sizeof(BENCH_T),
+			    (void)0,
+			    uint64_t hits = 0; for (uint64_t i = 0; i < BENCH_PROBES; i++) { hits += BENCH_FN(_count)(d, data[(i * 7919) % n], NULL); } bench_sink = hits,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+
+		BENCH_FN(_free)(d);
+	}
+
+	/**
+	 * the indexed ops look up BENCH_PROBES items of the data per call in a
+	 * copy of it with a hash index, built by name_index_enable.
+	 */
+	if (bench_enabled(cfg, type, "contains_indexed") || bench_enabled(cfg, type, "count_indexed")) {
+		d = BENCH_FN(_bench_new)(n);
+		BENCH_FN(_append_n)(d, data, n);
+		BENCH_FN(_index_enable)(d);
+
+		if (bench_enabled(cfg, type, r.op = "contains_indexed")) {
+			BENCH_MEASURE(cfg, r, BENCH_PROBES, BENCH_PROBES * sizeof(BENCH_T),
+			    (void)0,
+			    uint64_t hits = 0; for (uint64_t i = 0; i < BENCH_PROBES; i++) { hits += BENCH_FN(_contains)(d, data[(i * 7919) % n]); } bench_sink = hits,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+
+		if (bench_enabled(cfg, type, r.op = "count_indexed")) {
+			BENCH_MEASURE(cfg, r, BENCH_PROBES, BENCH_PROBES * sizeof(BENCH_T),
+			    (void)0,
+			    uint64_t hits = 0; for (uint64_t i = 0; i < BENCH_PROBES; i++) { hits += BENCH_FN(_count)(d, data[(i * 7919) % n], NULL); } bench_sink = hits,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+
+		BENCH_FN(_free)(d);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "foreach")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    uint64_t sum = 0; BENCH_FN(_foreach)(s, BENCH_FN(_bench_sum), &sum); bench_sink = sum,
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "foreach_block")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    uint64_t sum = 0; BENCH_FN(_foreach_block)(s, BENCH_FN(_bench_sum_block), &sum); bench_sink = sum,
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "sum")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    bench_sink = (uint64_t)BENCH_FN(_sum)(s),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "minmax")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    BENCH_T lo = 0; BENCH_T hi = 0,
+		    BENCH_FN(_minmax)(s, &lo, &hi),
+		    bench_sink = (uint64_t)lo + (uint64_t)hi);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "sort")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(n); BENCH_FN(_append_n)(d, data, n),
+		    BENCH_FN(_sort)(d, NULL),
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * remove_value drops the few items equal to one of the data from a
+	 * fresh copy, retain about half of them.
+	 */
+	if (bench_enabled(cfg, type, r.op = "remove_value")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(n); BENCH_FN(_append_n)(d, data, n),
+		    bench_sink = BENCH_FN(_remove_value)(d, data[n / 2]),
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "retain")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(n); BENCH_FN(_append_n)(d, data, n),
+		    bench_sink = BENCH_FN(_retain)(d, BENCH_FN(_bench_even), NULL),
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * insert_n puts a second copy of the data in the middle of a fresh
+	 * one, which grows it once and moves half of it.
+	 */
+	if (bench_enabled(cfg, type, r.op = "insert_n")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(n); BENCH_FN(_append_n)(d, data, n),
+		    bench_sink = (uint64_t)BENCH_FN(_insert_n)(d, n / 2, data, n),
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * deque_fifo pops the front of a deque holding the data and pushes it
+	 * back, n times per call, the queue staying n items long.
+	 */
+	if (bench_enabled(cfg, type, r.op = "deque_fifo")) {
+		BENCH_FN(_deque_t) *q = BENCH_FN(_deque_new_with_allocator)(n, &bench_allocator);
+
+		if (q != NULL) {
+			BENCH_FN(_deque_push_back_n)(q, data, n);
+			BENCH_MEASURE(cfg, r, n, bytes,
+			    (void)0,
+			    for (uint64_t i = 0; i < n; i++) { BENCH_T x; BENCH_FN(_deque_pop_front)(q, &x); BENCH_FN(_deque_push_back)(q, x); },
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+		BENCH_FN(_deque_free)(q);
+	}
+
+	/**
+	 * swap_remove empties a fresh copy from the front, delete_indices
+	 * removes every other item of one.
+	 */
+	if (bench_enabled(cfg, type, r.op = "swap_remove")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(n); BENCH_FN(_append_n)(d, data, n),
+		    for (uint64_t i = 0; i < n; i++) { BENCH_FN(_swap_remove)(d, 0); },
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "delete_indices")) {
+		size_t *idx = malloc(sizeof(size_t) * ((n + 1) / 2));
+
+		for (uint64_t i = 0; idx != NULL && i < (n + 1) / 2; i++) {
+			idx[i] = i * 2;
+		}
+		if (idx != NULL) {
+			BENCH_MEASURE(cfg, r, n, bytes,
+			    d = BENCH_FN(_bench_new)(n); BENCH_FN(_append_n)(d, data, n),
+			    bench_sink = (uint64_t)BENCH_FN(_delete_indices)(d, idx, (n + 1) / 2),
+			    BENCH_FN(_free)(d));
+			bench_report(cfg, &r);
+		}
+		free(idx);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "reverse")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    BENCH_FN(_reverse)(s),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "concat")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(0),
+		    BENCH_FN(_concat)(d, s),
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * copy overwrites a destination already holding as many items as the
+	 * source, so it's timed without growing.
+	 */
+	if (bench_enabled(cfg, type, r.op = "copy")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = BENCH_FN(_bench_new)(n); BENCH_FN(_fill)(d, 0, n),
+		    BENCH_FN(_copy)(s, d, true),
+		    BENCH_FN(_free)(d));
+		bench_report(cfg, &r);
+	}
+
+	BENCH_FN(_free)(s);
+	free(data);
+}
+
+void
+BENCH_CAT(bench_, BENCH_NAME)(const bench_config_t *cfg)
+{
+	for (size_t i = 0; i < cfg->sizes_len; i++) {
+		BENCH_FN(_bench_size)(cfg, cfg->sizes[i]);
+	}
+}
@@ -0,0 +1,181 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "../string_slice.h"
+
+#define BENCH_KEY_SIZE 16
+#define BENCH_PROBES 1024
+
+/**
+ * BENCH_KEY_LEN is the length of each key, BENCH_KEY_SIZE less its NUL.
+ */
+#define BENCH_KEY_LEN (BENCH_KEY_SIZE - 1)
+
+/**
+ * bench_string_fill appends the first n keys to the slice.
+ */
+static void
+bench_string_fill(string_slice_t *s, const char *keys, const uint64_t n)
+{
+	for (uint64_t i = 0; i < n; i++) {
+		string_slice_append_len(s, keys + i * BENCH_KEY_SIZE, BENCH_KEY_LEN);
+	}
+}
+
+static void
+bench_string_size(const bench_config_t *cfg, const uint64_t n)
+{
+	const char *type = "string_slice";
+	const uint64_t bytes = n * (sizeof(string_slice_entry_t) + BENCH_KEY_SIZE);
+	bench_result_t r = {.type = type, .n = n};
+	char probe[] = "probe";
+	string_slice_t *s;
+	string_slice_t *d = NULL;
+	char *keys;
+
+	keys = malloc(BENCH_KEY_SIZE * n);
+	if (keys == NULL) {
+		return;
+	}
+	for (uint64_t i = 0; i < n; i++) {
+		snprintf(keys + i * BENCH_KEY_SIZE, BENCH_KEY_SIZE, "%015llx", (unsigned long long)bench_rand());
+	}
+
+	s = string_slice_new(n);
+	if (s == NULL) {
+		free(keys);
+		return;
+	}
+	bench_string_fill(s, keys, n);
+
+	if (bench_enabled(cfg, type, r.op = "new_free")) {
+		BENCH_MEASURE(cfg, r, 1, bytes,
+		    (void)0,
+		    string_slice_free(string_slice_new_with_allocator(n, &bench_allocator)),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "append_cold")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = string_slice_new_with_allocator(0, &bench_allocator),
+		    bench_string_fill(d, keys, n),
+		    string_slice_free(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "append_reserved")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = string_slice_new_with_allocator(0, &bench_allocator); string_slice_reserve(d, n); string_slice_reserve_bytes(d, n * BENCH_KEY_SIZE),
+		    bench_string_fill(d, keys, n),
+		    string_slice_free(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "get")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    uint64_t sum = 0; for (uint64_t i = 0; i < n; i++) { sum += (unsigned char)*string_slice_get(s, i); } bench_sink = sum,
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "contains")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    bench_sink = string_slice_contains(s, probe),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "count")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    bench_sink = string_slice_count(s, probe, NULL),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	/**
+	 * the indexed ops look up BENCH_PROBES keys per call in a copy of the
+	 * slice with a hash index, built by string_slice_index_enable.
+	 */
+	if (bench_enabled(cfg, type, "contains_indexed") || bench_enabled(cfg, type, "count_indexed")) {
+		d = string_slice_new_with_allocator(n, &bench_allocator);
+		bench_string_fill(d, keys, n);
+		string_slice_index_enable(d);
+
+		if (bench_enabled(cfg, type, r.op = "contains_indexed")) {
+			BENCH_MEASURE(cfg, r, BENCH_PROBES, BENCH_PROBES * BENCH_KEY_SIZE,
+			    (void)0,
+			    uint64_t hits = 0; for (uint64_t i = 0; i < BENCH_PROBES; i++) { hits += string_slice_contains(d, keys + (i * 7919) % n * BENCH_KEY_SIZE); } bench_sink = hits,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+
+		if (bench_enabled(cfg, type, r.op = "count_indexed")) {
+			BENCH_MEASURE(cfg, r, BENCH_PROBES, BENCH_PROBES * BENCH_KEY_SIZE,
+			    (void)0,
+			    uint64_t hits = 0; for (uint64_t i = 0; i < BENCH_PROBES; i++) { hits += string_slice_count(d, keys + (i * 7919) % n * BENCH_KEY_SIZE, NULL); } bench_sink = hits,
+			    (void)0);
+			bench_report(cfg, &r);
+		}
+
+		string_slice_free(d);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "sort")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = string_slice_new_with_allocator(n, &bench_allocator); bench_string_fill(d, keys, n),
+		    string_slice_sort(d, NULL),
+		    string_slice_free(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "remove_value")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = string_slice_new_with_allocator(n, &bench_allocator); bench_string_fill(d, keys, n),
+		    bench_sink = string_slice_remove_value(d, keys + n / 2 * BENCH_KEY_SIZE),
+		    string_slice_free(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "reverse")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    (void)0,
+		    string_slice_reverse(s),
+		    (void)0);
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "concat")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = string_slice_new_with_allocator(0, &bench_allocator),
+		    string_slice_concat(d, s),
+		    string_slice_free(d));
+		bench_report(cfg, &r);
+	}
+
+	if (bench_enabled(cfg, type, r.op = "copy")) {
+		BENCH_MEASURE(cfg, r, n, bytes,
+		    d = string_slice_new_with_allocator(0, &bench_allocator),
+		    string_slice_copy(s, d, true),
+		    string_slice_free(d));
+		bench_report(cfg, &r);
+	}
+
+	string_slice_free(s);
+	free(keys);
+}
+
+void
+bench_string_slice(const bench_config_t *cfg)
+{
+	for (size_t i = 0; i < cfg->sizes_len; i++) {
+		bench_string_size(cfg, cfg->sizes[i]);
+	}
+}
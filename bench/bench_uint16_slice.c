@@ -0,0 +1,6 @@
+#include "../uint16_slice.h"
+
+#define BENCH_NAME uint16_slice
+#define BENCH_T uint16_t
+
+#include "bench_slice.h"
@@ -0,0 +1,6 @@
+#include "../uint32_slice.h"
+
+#define BENCH_NAME uint32_slice
+#define BENCH_T uint32_t
+
+#include "bench_slice.h"
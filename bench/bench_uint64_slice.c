@@ -0,0 +1,6 @@
+#include "../uint64_slice.h"
+
+#define BENCH_NAME uint64_slice
+#define BENCH_T uint64_t
+
+#include "bench_slice.h"
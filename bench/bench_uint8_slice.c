@@ -0,0 +1,6 @@
+#include "../uint8_slice.h"
+
+#define BENCH_NAME uint8_slice
+#define BENCH_T uint8_t
+
+#include "bench_slice.h"
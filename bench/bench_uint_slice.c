@@ -0,0 +1,6 @@
+#include "../uint_slice.h"
+
+#define BENCH_NAME uint_slice
+#define BENCH_T unsigned int
+
+#include "bench_slice.h"
@@ -0,0 +1,3326 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SLICE_H
+#define __SLICE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef __cplusplus
+#include <stdatomic.h>
+#endif
+
+#include "slice_allocator.h"
+#include "slice_growth.h"
+#include "slice_index.h"
+#include "slice_simd.h"
+#include "slice_sort.h"
+
+/**
+ * slice.h generates the slice types. SLICE_DECLARE(name, T) goes in a
+ * header and declares name_t, a growable array of items of type T, along
+ * with its view type, callback types and functions. SLICE_DEFINE(name, T)
+ * goes in exactly one source file and defines the functions. For example
+ *
+ *     SLICE_DECLARE(point_slice, struct point)
+ *     SLICE_DEFINE(point_slice, struct point)
+ *
+ * gives point_slice_new, point_slice_append and so on. Items of such a
+ * type are compared byte for byte when no compare function is given and a
+ * NULL sort_compare leaves their order untouched. SLICE_DEFINE_INT is
+ * SLICE_DEFINE for integer types, searching and counting with the vector
+ * kernels of slice_simd.h and sorting with the radix sort of slice_sort.h.
+ * Integer types can also have reductions, declared with
+ * SLICE_DECLARE_REDUCE and defined with SLICE_DEFINE_REDUCE, and sorted
+ * searches and inserts, declared with SLICE_DECLARE_SORTED and defined
+ * with SLICE_DEFINE_SORTED, and a hash index, declared with
+ * SLICE_DECLARE_INDEX and defined with SLICE_DEFINE_INDEX.
+ * SLICE_DECLARE_DEQUE and SLICE_DEFINE_DEQUE add name_deque_t, a ring
+ * buffer of items of any type for queues, and SLICE_DECLARE_CONCURRENT
+ * and SLICE_DEFINE_CONCURRENT name_concurrent_t, which many threads can
+ * append to at once. SLICE_DECLARE_CHUNKED and SLICE_DEFINE_CHUNKED add
+ * name_chunked_t, which grows without ever moving its items.
+ *
+ * SLICE_DECLARE makes the struct visible and defines get, len, cap, data
+ * and append, with their variants, as static inline so they compile down
+ * to a few instructions in the caller. Only an append that has to grow
+ * the slice calls into the library. SLICE_DECLARE_OPAQUE keeps the struct private and declares the
+ * fast paths as ordinary functions, which the source file then defines
+ * with SLICE_DEFINE_OPAQUE or SLICE_DEFINE_OPAQUE_INT.
+ *
+ * The built in types are opaque unless SLICE_INLINE is defined before the
+ * first slice header is included, in which case they're declared with
+ * SLICE_DECLARE. Both modes share one struct layout and the library keeps
+ * exporting the fast paths, so code built either way links against the
+ * same library.
+ *
+ * Callbacks are typed per slice, as in int32_slice_compare_func_t. The
+ * unprefixed compare_func_t, foreach_func_t and val_equal_func_t of older
+ * releases are only declared when SLICE_CALLBACK_ALIASES is defined, and
+ * then name the callback types of the first slice header included.
+ */
+
+/**
+ * SLICE_IN_BOUNDS is the index check made by get and view_get. Building
+ * with SLICE_NO_BOUNDS_CHECK drops it for release builds, an index out of
+ * range is then undefined behaviour like indexing an array. It applies
+ * wherever get is compiled: in the library when the library is built with
+ * it, and in callers that also define SLICE_INLINE.
+ */
+#ifdef SLICE_NO_BOUNDS_CHECK
+#define SLICE_IN_BOUNDS(idx, len) ((void)(len), 1)
+#else
+#define SLICE_IN_BOUNDS(idx, len) ((idx) < (len))
+#endif
+
+/**
+ * SLICE_IS_SIGNED is true for signed integer types: -1 converted to the
+ * type only stays below 1 if it's signed.
+ */
+#define SLICE_IS_SIGNED(T) ((T)-1 < (T)1)
+
+/**
+ * SLICE_BLOCK_SIZE is the number of bytes of items handed to a block
+ * callback at a time, small enough that a block read and written back
+ * stays in the L1 or L2 cache.
+ */
+#ifndef SLICE_BLOCK_SIZE
+#define SLICE_BLOCK_SIZE 16384
+#endif
+
+/**
+ * SLICE_BSEARCH_MIN_LEN is the length from which contains, index_of and
+ * count binary search a slice known to be sorted. Shorter slices are
+ * scanned, which is as fast for a few cache lines of items.
+ */
+#ifndef SLICE_BSEARCH_MIN_LEN
+#define SLICE_BSEARCH_MIN_LEN 64
+#endif
+
+/**
+ * SLICE_CHUNK_BYTES is the size of the chunks of a chunked slice, rounded
+ * down to a power of 2 number of items. Large enough that walking a chunk
+ * amortizes the directory lookup, small enough that adding one is a cheap
+ * allocation.
+ */
+#ifndef SLICE_CHUNK_BYTES
+#define SLICE_CHUNK_BYTES 65536
+#endif
+
+/**
+ * SLICE_CONCURRENT_MIN_SHIFT is the log2 of the smallest first segment of
+ * a concurrent slice, and SLICE_CONCURRENT_SEGMENTS the size of its
+ * segment directory, enough for any 64 bit length.
+ */
+#define SLICE_CONCURRENT_MIN_SHIFT 6
+#define SLICE_CONCURRENT_SEGMENTS 64
+
+/**
+ * sort_compare_func_t orders 2 items for qsort. It's the same for every
+ * slice type.
+ */
+typedef int (*sort_compare_func_t)(const void *x, const void *y);
+
+/**
+ * SLICE_STRUCT defines the layout of a slice. Slices created with
+ * name_new_inline keep their first items in inline_items, in the same
+ * allocation as the header. sorted is set while the items are known to be
+ * in ascending order: by name_sort with a NULL sort_compare, and for an
+ * empty slice. Anything that writes items clears it. index is the hash
+ * index of slice_index.h, NULL unless one has been asked for.
+ */
+#define SLICE_STRUCT(name, T)                                                    \
+struct name {                                                                    \
+    T *items;                                                                    \
+    uint64_t len;                                                                \
+    uint64_t cap;                                                                \
+    const slice_allocator_t *allocator;                                          \
+    slice_growth_t growth;                                                       \
+    bool sorted;                                                                 \
+    uint64_t reallocs;                                                           \
+    slice_index_t *index;                                                        \
+    T inline_items[];                                                            \
+};
+
+/**
+ * SLICE_DECLARE_TYPES declares the slice, view and callback types and the
+ * functions other than the fast paths.
+ */
+#define SLICE_DECLARE_TYPES(name, T)                                             \
+typedef bool (*name##_compare_func_t)(const T x, const T y, void *user_data);    \
+typedef void (*name##_foreach_func_t)(const T item, void *user_data);            \
+typedef bool (*name##_val_equal_func_t)(const T x, const T y, void *user_data);  \
+typedef void (*name##_block_func_t)(const T *items, const uint64_t n, void *user_data); \
+typedef void (*name##_transform_func_t)(T *items, const uint64_t n, void *user_data); \
+typedef void (*name##_map_func_t)(const T *in, T *out, const uint64_t n, void *user_data); \
+typedef bool (*name##_pred_func_t)(const T item, void *user_data);               \
+                                                                                 \
+typedef struct name name##_t;                                                    \
+                                                                                 \
+/**                                                                              \
+ * name_view_t is a window onto items owned by a slice, the equivalent of        \
+ * s[lo:hi] in Go. Views are cheap to pass by value and never own their          \
+ * items. A view is invalidated by anything that reallocates the slice it        \
+ * was taken from.                                                               \
+ */                                                                              \
+typedef struct {                                                                 \
+    T *items;                                                                    \
+    uint64_t len;                                                                \
+} name##_view_t;                                                                 \
+                                                                                 \
+/**                                                                              \
+ * name_new creates a pointer of type name_t, sets default values, and           \
+ * returns the pointer to the allocated memory. The user is responsible          \
+ * for freeing this memory.                                                      \
+ */                                                                              \
+name##_t*                                                                        \
+name##_new(const uint64_t cap);                                                  \
+                                                                                 \
+/**                                                                              \
+ * name_new_with_allocator creates a slice like name_new but takes all of        \
+ * its memory from the given allocator, including the memory used when it        \
+ * grows. The allocator must outlive the slice. A NULL allocator uses the        \
+ * C library.                                                                    \
+ */                                                                              \
+name##_t*                                                                        \
+name##_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator); \
+                                                                                 \
+/**                                                                              \
+ * name_new_inline creates a slice whose header and first cap items live         \
+ * in a single allocation, saving an allocation and a pointer hop for            \
+ * slices that stay small. Growing past cap moves the items to the heap          \
+ * transparently. The result is freed with name_free.                            \
+ */                                                                              \
+name##_t*                                                                        \
+name##_new_inline(const uint64_t cap);                                           \
+                                                                                 \
+/**                                                                              \
+ * name_new_inline_with_allocator is name_new_inline taking its memory           \
+ * from the given allocator. Paired with a pool whose blocks fit the header      \
+ * and cap items, creating a slice is a single free-list pop.                    \
+ */                                                                              \
+name##_t*                                                                        \
+name##_new_inline_with_allocator(const uint64_t cap, const slice_allocator_t *allocator); \
+                                                                                 \
+/**                                                                              \
+ * name_free frees the memory used by the given pointer.                         \
+ */                                                                              \
+void                                                                             \
+name##_free(name##_t *s);                                                        \
+                                                                                 \
+/**                                                                              \
+ * name_append_slow grows the slice and appends the value. It's the part         \
+ * of name_append that isn't inlined.                                            \
+ */                                                                              \
+void                                                                             \
+name##_append_slow(name##_t *s, const T val);                                    \
+                                                                                 \
+/**                                                                              \
+ * name_reverse the contents of the array.                                       \
+ */                                                                              \
+void                                                                             \
+name##_reverse(name##_t *s);                                                     \
+                                                                                 \
+/**                                                                              \
+ * name_compare takes 2 slices, compares them element by element and             \
+ * returns true if they are the same and false if they are not. A NULL           \
+ * compare function compares the items for equality with a single memcmp.        \
+ */                                                                              \
+bool                                                                             \
+name##_compare(const name##_t *s1, const name##_t *s2, name##_compare_func_t compare, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_copy copies the items of the first slice into the second and             \
+ * returns the number of items copied. With overwrite the second slice           \
+ * becomes a copy of the first, growing as needed, and 0 is returned if it       \
+ * can't grow. Without it, like Go's copy, the items are copied over the         \
+ * ones the second slice already has, as many as both slices hold, and its       \
+ * length stays the same.                                                        \
+ */                                                                              \
+uint64_t                                                                         \
+name##_copy(const name##_t *s1, name##_t *s2, bool overwrite);                   \
+                                                                                 \
+/**                                                                              \
+ * name_contains checks to see if the given value is in the slice. A slice       \
+ * with a hash index looks the value up in it, one known to be sorted is         \
+ * binary searched.                                                              \
+ */                                                                              \
+bool                                                                             \
+name##_contains(const name##_t *s, const T val);                                 \
+                                                                                 \
+/**                                                                              \
+ * name_index_of returns the index of the first occurrence of the given          \
+ * value or -1 if it isn't in the slice. A slice known to be sorted is           \
+ * binary searched.                                                              \
+ */                                                                              \
+int64_t                                                                          \
+name##_index_of(const name##_t *s, const T val);                                 \
+                                                                                 \
+/**                                                                              \
+ * name_delete removes the item at the given index and returns the new           \
+ * length, or -1 if the index is out of range.                                   \
+ */                                                                              \
+int                                                                              \
+name##_delete(name##_t *s, const uint64_t idx);                                  \
+                                                                                 \
+/**                                                                              \
+ * name_swap_remove removes the item at the given index by moving the last       \
+ * item into its place, which doesn't preserve the order of the items but        \
+ * takes constant time. Returns the new length, or -1 if the index is out        \
+ * of range.                                                                     \
+ */                                                                              \
+int64_t                                                                          \
+name##_swap_remove(name##_t *s, const uint64_t idx);                             \
+                                                                                 \
+/**                                                                              \
+ * name_delete_indices removes the items at the n given indices in a single      \
+ * pass, moving each run of kept items down once. The indices must be in         \
+ * ascending order, repeats being ignored. Returns the new length, or -1,        \
+ * leaving the slice as it was, if they aren't ascending or one is out of        \
+ * range.                                                                        \
+ */                                                                              \
+int64_t                                                                          \
+name##_delete_indices(name##_t *s, const size_t *idx, const size_t n);           \
+                                                                                 \
+/**                                                                              \
+ * name_retain keeps the items for which pred returns true and removes the       \
+ * others, in a single pass that keeps the order of the items kept, and          \
+ * returns the new length. pred is called once per item, in order.               \
+ */                                                                              \
+uint64_t                                                                         \
+name##_retain(name##_t *s, name##_pred_func_t pred, void *user_data);            \
+                                                                                 \
+/**                                                                              \
+ * name_remove_value removes every item equal to val in a single pass that       \
+ * keeps the order of the others, and returns the new length. Integer            \
+ * items are compacted with vector instructions where available.                 \
+ */                                                                              \
+uint64_t                                                                         \
+name##_remove_value(name##_t *s, const T val);                                   \
+                                                                                 \
+/**                                                                              \
+ * name_replace_by_idx replaces the value at the given index with the new        \
+ * value.                                                                        \
+ */                                                                              \
+int                                                                              \
+name##_replace_by_idx(name##_t *s, const uint64_t idx, const T val);             \
+                                                                                 \
+/**                                                                              \
+ * name_replace_by_val replaces occurrences of the value with the new            \
+ * value, the number of times given. A NULL compare function matches items       \
+ * equal to old_val and, when times covers the whole slice, runs as a            \
+ * branch free loop.                                                             \
+ */                                                                              \
+int                                                                              \
+name##_replace_by_val(name##_t *s, const T old_val, const T new_val, uint64_t times, name##_compare_func_t compare); \
+                                                                                 \
+/**                                                                              \
+ * name_first returns the first element of the slice.                            \
+ */                                                                              \
+T                                                                                \
+name##_first(name##_t *s);                                                       \
+                                                                                 \
+/**                                                                              \
+ * name_last returns the last element of the slice.                              \
+ */                                                                              \
+T                                                                                \
+name##_last(name##_t *s);                                                        \
+                                                                                 \
+/**                                                                              \
+ * name_foreach iterates through the slice and runs the user provided            \
+ * function on each item. Additional user data can be provided using the         \
+ * user_data argument.                                                           \
+ */                                                                              \
+int                                                                              \
+name##_foreach(name##_t *s, name##_foreach_func_t ift, void *user_data);         \
+                                                                                 \
+/**                                                                              \
+ * name_foreach_block runs the user provided function on consecutive             \
+ * blocks of items, passing each as a pointer and a count, so the function       \
+ * can work on many items per call. Blocks are at most SLICE_BLOCK_SIZE          \
+ * bytes.                                                                        \
+ */                                                                              \
+int                                                                              \
+name##_foreach_block(const name##_t *s, name##_block_func_t fn, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_transform runs the user provided function on consecutive blocks of       \
+ * items, which it may modify in place.                                          \
+ */                                                                              \
+int                                                                              \
+name##_transform(name##_t *s, name##_transform_func_t fn, void *user_data);      \
+                                                                                 \
+/**                                                                              \
+ * name_map_into runs the user provided function on consecutive blocks of        \
+ * the first slice, writing its results to the same positions of dst. dst        \
+ * ends up with as many items as the first slice and its length is               \
+ * returned. dst may be the first slice, making it a transform.                  \
+ */                                                                              \
+uint64_t                                                                         \
+name##_map_into(const name##_t *s, name##_t *dst, name##_map_func_t fn, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_sort uses the Quick Sort algorithm to sort the contents of the           \
+ * slice. A NULL sort_compare sorts integer items in ascending order with        \
+ * a built in radix sort, which is much faster than going through a              \
+ * comparison function, and marks the slice as sorted so later searches          \
+ * can binary search it. The radix sort's scratch buffer comes from the          \
+ * slice's allocator.                                                            \
+ */                                                                              \
+void                                                                             \
+name##_sort(name##_t *s, sort_compare_func_t sort_compare);                      \
+                                                                                 \
+/**                                                                              \
+ * name_repeat takes a value and repeats that value in the slice for the         \
+ * number of times given and returns the new length of the slice.                \
+ */                                                                              \
+uint64_t                                                                         \
+name##_repeat(name##_t *s, const T val, const uint64_t times);                   \
+                                                                                 \
+/**                                                                              \
+ * name_count counts the occurrences of the given value. A NULL compare          \
+ * function counts items equal to val, using vector instructions for             \
+ * integer items, a hash index lookup if the slice has one, or 2 binary          \
+ * searches if the slice is known to be sorted.                                  \
+ */                                                                              \
+uint64_t                                                                         \
+name##_count(name##_t *s, const T val, name##_compare_func_t compare);           \
+                                                                                 \
+/**                                                                              \
+ * name_grow grows the slice by the given size.                                  \
+ */                                                                              \
+uint64_t                                                                         \
+name##_grow(name##_t *s, const uint64_t size);                                   \
+                                                                                 \
+/**                                                                              \
+ * name_concat combine the second slice into the first.                          \
+ */                                                                              \
+uint64_t                                                                         \
+name##_concat(name##_t *s1, const name##_t *s2);                                 \
+                                                                                 \
+/**                                                                              \
+ * name_append_n appends n items copied from buf, growing the slice at           \
+ * most once, and returns the new length. buf must not point into the            \
+ * slice itself.                                                                 \
+ */                                                                              \
+uint64_t                                                                         \
+name##_append_n(name##_t *s, const T *buf, const uint64_t n);                    \
+                                                                                 \
+/**                                                                              \
+ * name_append_slice appends the contents of the second slice to the first       \
+ * in one copy and returns the new length. Both may be the same slice.           \
+ */                                                                              \
+uint64_t                                                                         \
+name##_append_slice(name##_t *s1, const name##_t *s2);                           \
+                                                                                 \
+/**                                                                              \
+ * name_insert inserts val at the given index, moving the items from there       \
+ * on up by one, and returns the new length, or -1 if the index is past the      \
+ * end or the slice couldn't grow. An index equal to the length appends. A       \
+ * sorted slice stays sorted when val is in order with its neighbours.           \
+ */                                                                              \
+int64_t                                                                          \
+name##_insert(name##_t *s, const uint64_t idx, const T val);                     \
+                                                                                 \
+/**                                                                              \
+ * name_insert_n inserts n items copied from buf at the given index,             \
+ * growing the slice at most once and moving the later items with a single       \
+ * memmove, and returns the new length, or -1 if the index is past the end       \
+ * or the slice couldn't grow. buf must not point into the slice itself.         \
+ */                                                                              \
+int64_t                                                                          \
+name##_insert_n(name##_t *s, const uint64_t idx, const T *buf, const uint64_t n); \
+                                                                                 \
+/**                                                                              \
+ * name_fill replaces the contents of the slice with n copies of the given       \
+ * value and returns the new length.                                             \
+ */                                                                              \
+uint64_t                                                                         \
+name##_fill(name##_t *s, const T val, const uint64_t n);                         \
+                                                                                 \
+/**                                                                              \
+ * name_set_growth sets the policy used to pick the new capacity when an         \
+ * append or concat runs out of room. Slices start out with                      \
+ * SLICE_GROWTH_DOUBLE.                                                          \
+ */                                                                              \
+void                                                                             \
+name##_set_growth(name##_t *s, const slice_growth_t growth);                     \
+                                                                                 \
+/**                                                                              \
+ * name_reserve makes sure the slice can hold at least n items without           \
+ * reallocating and returns the resulting capacity.                              \
+ */                                                                              \
+uint64_t                                                                         \
+name##_reserve(name##_t *s, const uint64_t n);                                   \
+                                                                                 \
+/**                                                                              \
+ * name_shrink_to_fit gives unused capacity back to the allocator and            \
+ * returns the new capacity. Items stored inline with the header are left        \
+ * where they are.                                                               \
+ */                                                                              \
+uint64_t                                                                         \
+name##_shrink_to_fit(name##_t *s);                                               \
+                                                                                 \
+/**                                                                              \
+ * name_reallocs returns the number of times the slice's items have been         \
+ * reallocated since it was created.                                             \
+ */                                                                              \
+uint64_t                                                                         \
+name##_reallocs(const name##_t *s);                                              \
+                                                                                 \
+/**                                                                              \
+ * name_as_view returns a view over all items of the slice.                      \
+ */                                                                              \
+name##_view_t                                                                    \
+name##_as_view(const name##_t *s);                                               \
+                                                                                 \
+/**                                                                              \
+ * name_view returns a view over items lo up to, but not including, hi           \
+ * without copying them. An empty view is returned if the bounds are out         \
+ * of range.                                                                     \
+ */                                                                              \
+name##_view_t                                                                    \
+name##_view(const name##_t *s, const uint64_t lo, const uint64_t hi);            \
+                                                                                 \
+/**                                                                              \
+ * name_view_sub narrows a view the same way name_view does a slice. The         \
+ * bounds are relative to the view.                                              \
+ */                                                                              \
+name##_view_t                                                                    \
+name##_view_sub(const name##_view_t v, const uint64_t lo, const uint64_t hi);    \
+                                                                                 \
+/**                                                                              \
+ * name_view_get returns the item at the given index of the view, or 0 if        \
+ * the index is out of range.                                                    \
+ */                                                                              \
+T                                                                                \
+name##_view_get(const name##_view_t v, const uint64_t idx);                      \
+                                                                                 \
+/**                                                                              \
+ * name_view_contains checks to see if the given value is in the view.           \
+ */                                                                              \
+bool                                                                             \
+name##_view_contains(const name##_view_t v, const T val);                        \
+                                                                                 \
+/**                                                                              \
+ * name_view_index_of returns the index within the view of the first             \
+ * occurrence of the given value or -1 if it isn't there.                        \
+ */                                                                              \
+int64_t                                                                          \
+name##_view_index_of(const name##_view_t v, const T val);                        \
+                                                                                 \
+/**                                                                              \
+ * name_view_count counts the occurrences of the given value in the view.        \
+ */                                                                              \
+uint64_t                                                                         \
+name##_view_count(const name##_view_t v, const T val, name##_compare_func_t compare); \
+                                                                                 \
+/**                                                                              \
+ * name_view_foreach runs the user provided function on each item of the         \
+ * view.                                                                         \
+ */                                                                              \
+int                                                                              \
+name##_view_foreach(const name##_view_t v, name##_foreach_func_t ift, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_view_foreach_block runs the user provided function on consecutive        \
+ * blocks of the view's items.                                                   \
+ */                                                                              \
+int                                                                              \
+name##_view_foreach_block(const name##_view_t v, name##_block_func_t fn, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_view_transform runs the user provided function on consecutive            \
+ * blocks of the view's items, which it may modify in place.                     \
+ */                                                                              \
+int                                                                              \
+name##_view_transform(const name##_view_t v, name##_transform_func_t fn, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_view_compare compares 2 views element by element and returns true        \
+ * if they are the same.                                                         \
+ */                                                                              \
+bool                                                                             \
+name##_view_compare(const name##_view_t v1, const name##_view_t v2, name##_compare_func_t compare, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_view_sort sorts the items of the view in place, leaving the rest         \
+ * of the underlying slice untouched. A NULL sort_compare sorts in the           \
+ * same way name_sort does, taking the scratch buffer from malloc. Views         \
+ * don't know their slice, or its allocator, so writing to a sorted slice        \
+ * through a view, with this or name_view_transform, has to be followed by       \
+ * name_set_sorted(s, false) where it's declared, and writing to a slice         \
+ * with a hash index by name_index_invalidate(s).                                \
+ */                                                                              \
+void                                                                             \
+name##_view_sort(const name##_view_t v, sort_compare_func_t sort_compare);
+
+/**
+ * SLICE_FAST_PATHS defines get, get_unchecked, len, cap, data, data_mut
+ * and append with the given storage class, static inline in headers and
+ * external in the library.
+ */
+#define SLICE_FAST_PATHS(name, T, attr)                                          \
+/**                                                                              \
+ * name_get attempts to retrieve the value at the given index. If the            \
+ * index is out of range, 0 is returned indicating an error.                     \
+ */                                                                              \
+attr T                                                                           \
+name##_get(const name##_t *s, const uint64_t idx)                                \
+{                                                                                \
+	if (SLICE_IN_BOUNDS(idx, s->len)) {                                      \
+		return s->items[idx];                                            \
+	}                                                                        \
+                                                                                 \
+	return (T){0};                                                           \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_get_unchecked returns the item at the given index without checking       \
+ * it, so a 0 item can't be mistaken for an error. The index must be less        \
+ * than name_len.                                                                \
+ */                                                                              \
+attr T                                                                           \
+name##_get_unchecked(const name##_t *s, const uint64_t idx)                      \
+{                                                                                \
+	return s->items[idx];                                                    \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_len returns the length of the slice.                                     \
+ */                                                                              \
+attr uint64_t                                                                    \
+name##_len(const name##_t *s)                                                    \
+{                                                                                \
+	if (s == NULL) {                                                         \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	return s->len;                                                           \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_cap returns the capacity of the slice.                                   \
+ */                                                                              \
+attr uint64_t                                                                    \
+name##_cap(const name##_t *s)                                                    \
+{                                                                                \
+	if (s == NULL) {                                                         \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	return s->cap;                                                           \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_data returns a pointer to the first of the name_len items of the         \
+ * slice. It's invalidated by anything that reallocates the slice.               \
+ */                                                                              \
+attr const T*                                                                    \
+name##_data(const name##_t *s)                                                   \
+{                                                                                \
+	return s->items;                                                         \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_data_mut is name_data for callers that write to the items in             \
+ * place, the length stays name_len. The slice is no longer treated as           \
+ * sorted and its hash index is stale until name_index_build.                    \
+ */                                                                              \
+attr T*                                                                          \
+name##_data_mut(name##_t *s)                                                     \
+{                                                                                \
+	s->sorted = false;                                                       \
+	slice_index_invalidate(s->index);                                        \
+                                                                                 \
+	return s->items;                                                         \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_append attempts to append the data to the given array. Slices with       \
+ * a hash index take the out of line path, which adds the value to it.           \
+ */                                                                              \
+attr void                                                                        \
+name##_append(name##_t *s, const T val)                                          \
+{                                                                                \
+	s->sorted = false;                                                       \
+	if (__builtin_expect(s->len < s->cap && s->index == NULL, 1)) {          \
+		s->items[s->len++] = val;                                        \
+		return;                                                          \
+	}                                                                        \
+	name##_append_slow(s, val);                                              \
+}
+
+/**
+ * SLICE_DECLARE declares a slice type with its struct visible and the
+ * fast paths inlined into callers.
+ */
+#define SLICE_DECLARE(name, T)                                                   \
+SLICE_STRUCT(name, T)                                                            \
+SLICE_DECLARE_TYPES(name, T)                                                     \
+SLICE_FAST_PATHS(name, T, static inline)
+
+/**
+ * SLICE_DECLARE_OPAQUE declares a slice type whose struct is private to
+ * the source file defining it.
+ */
+#define SLICE_DECLARE_OPAQUE(name, T)                                            \
+SLICE_DECLARE_TYPES(name, T)                                                     \
+                                                                                 \
+T                                                                                \
+name##_get(const name##_t *s, const uint64_t idx);                               \
+                                                                                 \
+T                                                                                \
+name##_get_unchecked(const name##_t *s, const uint64_t idx);                     \
+                                                                                 \
+uint64_t                                                                         \
+name##_len(const name##_t *s);                                                   \
+                                                                                 \
+uint64_t                                                                         \
+name##_cap(const name##_t *s);                                                   \
+                                                                                 \
+const T*                                                                         \
+name##_data(const name##_t *s);                                                  \
+                                                                                 \
+T*                                                                               \
+name##_data_mut(name##_t *s);                                                    \
+                                                                                 \
+void                                                                             \
+name##_append(name##_t *s, const T val);
+
+/**
+ * SLICE_DECLARE_BUILTIN declares one of the built in types, inline or
+ * opaque depending on SLICE_INLINE.
+ */
+#ifdef SLICE_INLINE
+#define SLICE_DECLARE_BUILTIN(name, T) SLICE_DECLARE(name, T)
+#else
+#define SLICE_DECLARE_BUILTIN(name, T) SLICE_DECLARE_OPAQUE(name, T)
+#endif
+
+/**
+ * SLICE_KERNELS defines the equality, ordering, search, count and sort
+ * helpers for items of any type. Items are equal when their bytes are and
+ * ordered as memcmp orders them. items_sort returns whether it left the
+ * items in that order, which it only does for fewer than 2 items. There's
+ * no hash index for these items so the index helpers are never reached.
+ */
+#define SLICE_KERNELS(name, T)                                                   \
+static inline bool                                                               \
+name##_item_eq(const T x, const T y)                                             \
+{                                                                                \
+	return memcmp(&x, &y, sizeof(T)) == 0;                                   \
+}                                                                                \
+                                                                                 \
+static inline bool                                                               \
+name##_item_lt(const T x, const T y)                                             \
+{                                                                                \
+	return memcmp(&x, &y, sizeof(T)) < 0;                                    \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_find(const T *items, const uint64_t n, const T val)                 \
+{                                                                                \
+	for (uint64_t i = 0; i < n; i++) {                                       \
+		if (name##_item_eq(items[i], val)) {                             \
+			return i;                                                \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return n;                                                                \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_count(const T *items, const uint64_t n, const T val)                \
+{                                                                                \
+	uint64_t count = 0;                                                      \
+                                                                                 \
+	for (uint64_t i = 0; i < n; i++) {                                       \
+		count += name##_item_eq(items[i], val);                          \
+	}                                                                        \
+                                                                                 \
+	return count;                                                            \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_items_remove removes the items equal to val without branching on         \
+ * the compare, the write cursor only advancing past items that are kept.        \
+ */                                                                              \
+static inline uint64_t                                                           \
+name##_items_remove(T *items, const uint64_t n, const T val)                     \
+{                                                                                \
+	uint64_t j = 0;                                                          \
+                                                                                 \
+	for (uint64_t i = 0; i < n; i++) {                                       \
+		T x = items[i];                                                  \
+		items[j] = x;                                                    \
+		j += !name##_item_eq(x, val);                                    \
+	}                                                                        \
+                                                                                 \
+	return j;                                                                \
+}                                                                                \
+                                                                                 \
+static inline bool                                                               \
+name##_items_sort(T *items, const uint64_t n, const slice_allocator_t *allocator) \
+{                                                                                \
+	(void)items;                                                             \
+	(void)allocator;                                                         \
+                                                                                 \
+	return n < 2;                                                            \
+}                                                                                \
+                                                                                 \
+static inline int                                                                \
+name##_item_index(slice_index_t *ix, const T val, const uint64_t n)              \
+{                                                                                \
+	(void)ix;                                                                \
+	(void)val;                                                               \
+	(void)n;                                                                 \
+                                                                                 \
+	return -1;                                                               \
+}                                                                                \
+                                                                                 \
+static inline int                                                                \
+name##_items_index(slice_index_t *ix, const T *items, const uint64_t n)          \
+{                                                                                \
+	(void)ix;                                                                \
+	(void)items;                                                             \
+	(void)n;                                                                 \
+                                                                                 \
+	return -1;                                                               \
+}                                                                                \
+                                                                                 \
+static inline void                                                               \
+name##_item_unindex(slice_index_t *ix, const T val, const uint64_t n)            \
+{                                                                                \
+	(void)ix;                                                                \
+	(void)val;                                                               \
+	(void)n;                                                                 \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_index_count(const slice_index_t *ix, const T val)                   \
+{                                                                                \
+	(void)ix;                                                                \
+	(void)val;                                                               \
+                                                                                 \
+	return 0;                                                                \
+}
+
+/**
+ * SLICE_KERNELS_INT defines the helpers for integer items using the
+ * kernels picked for the CPU. The item width is a sizeof known at compile
+ * time so the dispatch on it folds away.
+ */
+#define SLICE_KERNELS_INT(name, T)                                               \
+static inline bool                                                               \
+name##_item_eq(const T x, const T y)                                             \
+{                                                                                \
+	return x == y;                                                           \
+}                                                                                \
+                                                                                 \
+static inline bool                                                               \
+name##_item_lt(const T x, const T y)                                             \
+{                                                                                \
+	return x < y;                                                            \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_find(const T *items, const uint64_t n, const T val)                 \
+{                                                                                \
+	return slice_simd_find(items, n, sizeof(T), (uint64_t)val);              \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_count(const T *items, const uint64_t n, const T val)                \
+{                                                                                \
+	return slice_simd_count(items, n, sizeof(T), (uint64_t)val);             \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_remove(T *items, const uint64_t n, const T val)                     \
+{                                                                                \
+	return slice_simd_remove(items, n, sizeof(T), (uint64_t)val);            \
+}                                                                                \
+                                                                                 \
+static inline bool                                                               \
+name##_items_sort(T *items, const uint64_t n, const slice_allocator_t *allocator) \
+{                                                                                \
+	if (n >= 2) {                                                            \
+		slice_sort(items, n, sizeof(T), SLICE_IS_SIGNED(T), allocator);  \
+	}                                                                        \
+                                                                                 \
+	return true;                                                             \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_item_index adds n occurrences of val to the hash index, items being      \
+ * their own keys, and name_items_index adds n items. Both return -1 if          \
+ * the index couldn't grow. name_item_unindex removes n occurrences.             \
+ */                                                                              \
+static inline int                                                                \
+name##_item_index(slice_index_t *ix, const T val, const uint64_t n)              \
+{                                                                                \
+	return slice_index_add(ix, (uint64_t)val, 0, n, NULL, NULL);             \
+}                                                                                \
+                                                                                 \
+static inline int                                                                \
+name##_items_index(slice_index_t *ix, const T *items, const uint64_t n)          \
+{                                                                                \
+	for (uint64_t i = 0; i < n; i++) {                                       \
+		if (name##_item_index(ix, items[i], 1) != 0) {                   \
+			return -1;                                               \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+static inline void                                                               \
+name##_item_unindex(slice_index_t *ix, const T val, const uint64_t n)            \
+{                                                                                \
+	slice_index_remove(ix, (uint64_t)val, n, NULL, NULL);                    \
+}                                                                                \
+                                                                                 \
+static inline uint64_t                                                           \
+name##_items_index_count(const slice_index_t *ix, const T val)                   \
+{                                                                                \
+	return slice_index_count(ix, (uint64_t)val, NULL, NULL);                 \
+}
+
+/**
+ * SLICE_DEFINE_FUNCS defines every function declared by
+ * SLICE_DECLARE_TYPES. The struct and the kernels have to be defined
+ * first.
+ */
+#define SLICE_DEFINE_FUNCS(name, T)                                              \
+/**                                                                              \
+ * name_resize makes room for cap items. Slices created with                     \
+ * name_new_inline keep their items in the same allocation as the header         \
+ * so the first resize past that block copies them out to the heap instead       \
+ * of handing them to realloc. Returns -1 if the allocation fails.               \
+ */                                                                              \
+static int                                                                       \
+name##_resize(name##_t *s, const uint64_t cap)                                   \
+{                                                                                \
+	T *items;                                                                \
+                                                                                 \
+	if (s->items == s->inline_items) {                                       \
+		if (cap <= s->cap) {                                             \
+			return 0;                                                \
+		}                                                                \
+                                                                                 \
+		items = slice_alloc(s->allocator, sizeof(T) * cap);              \
+		if (items == NULL) {                                             \
+			return -1;                                               \
+		}                                                                \
+		memcpy(items, s->items, sizeof(T) * s->len);                     \
+	} else {                                                                 \
+		items = slice_realloc(s->allocator, s->items, sizeof(T) * s->cap, sizeof(T) * cap); \
+		if (items == NULL) {                                             \
+			return -1;                                               \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	s->items = items;                                                        \
+	s->cap = cap;                                                            \
+	s->reallocs++;                                                           \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_make_room makes sure n more items fit after the current length,          \
+ * growing at most once according to the slice's growth policy.                  \
+ */                                                                              \
+static int                                                                       \
+name##_make_room(name##_t *s, const uint64_t n)                                  \
+{                                                                                \
+	if (s->len + n <= s->cap) {                                              \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	uint64_t cap = slice_growth_next_cap(s->growth, s->cap, s->len + n, sizeof(T)); \
+                                                                                 \
+	return name##_resize(s, cap);                                            \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_block_items returns the number of items handed to a block callback       \
+ * at a time, at least 1 however large the items are.                            \
+ */                                                                              \
+static inline uint64_t                                                           \
+name##_block_items(void)                                                         \
+{                                                                                \
+	return SLICE_BLOCK_SIZE / sizeof(T) > 0 ? SLICE_BLOCK_SIZE / sizeof(T) : 1; \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_items_lower_bound returns the index of the first of n ascending          \
+ * items that isn't less than val, or n if there's none. Each step picks         \
+ * the next half with a select rather than a branch, and both candidates         \
+ * for the following probe are prefetched so the cache misses of a large         \
+ * slice overlap.                                                                \
+ */                                                                              \
+static inline uint64_t                                                           \
+name##_items_lower_bound(const T *items, uint64_t n, const T val)                \
+{                                                                                \
+	const T *base = items;                                                   \
+                                                                                 \
+	if (n == 0) {                                                            \
+		return 0;                                                        \
+	}                                                                        \
+	while (n > 1) {                                                          \
+		uint64_t half = n / 2;                                           \
+		__builtin_prefetch(base + half / 2);                             \
+		__builtin_prefetch(base + half + half / 2);                      \
+		base = name##_item_lt(base[half], val) ? base + half : base;     \
+		n -= half;                                                       \
+	}                                                                        \
+                                                                                 \
+	return (uint64_t)(base - items) + name##_item_lt(*base, val);            \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_items_upper_bound returns the index of the first of n ascending          \
+ * items greater than val, or n if there's none.                                 \
+ */                                                                              \
+static inline uint64_t                                                           \
+name##_items_upper_bound(const T *items, uint64_t n, const T val)                \
+{                                                                                \
+	const T *base = items;                                                   \
+                                                                                 \
+	if (n == 0) {                                                            \
+		return 0;                                                        \
+	}                                                                        \
+	while (n > 1) {                                                          \
+		uint64_t half = n / 2;                                           \
+		__builtin_prefetch(base + half / 2);                             \
+		__builtin_prefetch(base + half + half / 2);                      \
+		base = name##_item_lt(val, base[half]) ? base : base + half;     \
+		n -= half;                                                       \
+	}                                                                        \
+                                                                                 \
+	return (uint64_t)(base - items) + !name##_item_lt(val, *base);           \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_index_ready returns the slice's hash index if it's up to date, or        \
+ * NULL if there's none or writes through a view or raw pointer have left        \
+ * it stale, in which case the caller falls back to searching the items.         \
+ * Queries only ever read the index, the slice's writes keep it up to date,      \
+ * so they're safe to run from several threads at once.                          \
+ */                                                                              \
+static inline const slice_index_t*                                               \
+name##_index_ready(const name##_t *s)                                            \
+{                                                                                \
+	return slice_index_live(s->index) ? s->index : NULL;                     \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_index_append adds the n items appended at idx to the slice's hash        \
+ * index, if it has an up to date one. An index that can't grow is left          \
+ * stale.                                                                        \
+ */                                                                              \
+static inline void                                                               \
+name##_index_append(name##_t *s, const uint64_t idx, const uint64_t n)           \
+{                                                                                \
+	if (slice_index_live(s->index) && name##_items_index(s->index, s->items + idx, n) != 0) { \
+		slice_index_invalidate(s->index);                                \
+	}                                                                        \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_index_put adds n occurrences of val to the slice's hash index, and       \
+ * name_index_drop removes them before the items are dropped or written          \
+ * over, if it has an up to date one.                                            \
+ */                                                                              \
+static inline void                                                               \
+name##_index_put(name##_t *s, const T val, const uint64_t n)                     \
+{                                                                                \
+	if (slice_index_live(s->index) && n != 0 && name##_item_index(s->index, val, n) != 0) { \
+		slice_index_invalidate(s->index);                                \
+	}                                                                        \
+}                                                                                \
+                                                                                 \
+static inline void                                                               \
+name##_index_drop(name##_t *s, const T val, const uint64_t n)                    \
+{                                                                                \
+	if (slice_index_live(s->index) && n != 0) {                              \
+		name##_item_unindex(s->index, val, n);                           \
+	}                                                                        \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_index_rebuild rebuilds the slice's hash index from its items, for        \
+ * writes that change too many of them to follow one by one. The table           \
+ * grows with the distinct items found rather than being sized for the           \
+ * length, which would waste most of it on slices with many duplicates.          \
+ * Returns -1 if there's no index or it can't be built, leaving it stale.        \
+ */                                                                              \
+static inline int                                                                \
+name##_index_rebuild(name##_t *s)                                                \
+{                                                                                \
+	slice_index_t *ix = s->index;                                            \
+                                                                                 \
+	if (ix == NULL) {                                                        \
+		return -1;                                                       \
+	}                                                                        \
+	if (slice_index_reset(ix, 0) != 0 ||                                     \
+	    name##_items_index(ix, s->items, s->len) != 0) {                     \
+		ix->valid = false;                                               \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_bsearchable reports whether the slice is sorted and long enough          \
+ * for a binary search to beat a scan.                                           \
+ */                                                                              \
+static inline bool                                                               \
+name##_bsearchable(const name##_t *s)                                            \
+{                                                                                \
+	return s->sorted && s->len >= SLICE_BSEARCH_MIN_LEN;                     \
+}                                                                                \
+                                                                                 \
+name##_t*                                                                        \
+name##_new(const uint64_t cap)                                                   \
+{                                                                                \
+	return name##_new_with_allocator(cap, NULL);                             \
+}                                                                                \
+                                                                                 \
+name##_t*                                                                        \
+name##_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator) \
+{                                                                                \
+	name##_t *s = slice_alloc(allocator, sizeof(name##_t));                  \
+	if (s == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	s->items = slice_alloc(allocator, sizeof(T) * cap);                      \
+	if (s->items == NULL && cap != 0) {                                      \
+		slice_free(allocator, s);                                        \
+		return NULL;                                                     \
+	}                                                                        \
+	s->len = 0;                                                              \
+	s->cap = cap;                                                            \
+	s->allocator = allocator;                                                \
+	s->growth = SLICE_GROWTH_DOUBLE;                                         \
+	s->sorted = true;                                                        \
+	s->reallocs = 0;                                                         \
+	s->index = NULL;                                                         \
+                                                                                 \
+	return s;                                                                \
+}                                                                                \
+                                                                                 \
+name##_t*                                                                        \
+name##_new_inline(const uint64_t cap)                                            \
+{                                                                                \
+	return name##_new_inline_with_allocator(cap, NULL);                      \
+}                                                                                \
+                                                                                 \
+name##_t*                                                                        \
+name##_new_inline_with_allocator(const uint64_t cap, const slice_allocator_t *allocator) \
+{                                                                                \
+	name##_t *s = slice_alloc(allocator, sizeof(name##_t) + sizeof(T) * cap); \
+	if (s == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+	s->items = s->inline_items;                                              \
+	s->len = 0;                                                              \
+	s->cap = cap;                                                            \
+	s->allocator = allocator;                                                \
+	s->growth = SLICE_GROWTH_DOUBLE;                                         \
+	s->sorted = true;                                                        \
+	s->reallocs = 0;                                                         \
+	s->index = NULL;                                                         \
+                                                                                 \
+	return s;                                                                \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_free(name##_t *s)                                                         \
+{                                                                                \
+	if (s == NULL) {                                                         \
+		return;                                                          \
+	}                                                                        \
+                                                                                 \
+	if (s->items != s->inline_items) {                                       \
+		slice_free(s->allocator, s->items);                              \
+	}                                                                        \
+	slice_index_free(s->index);                                              \
+	slice_free(s->allocator, s);                                             \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_append_slow(name##_t *s, const T val)                                     \
+{                                                                                \
+	s->sorted = false;                                                       \
+	if (name##_make_room(s, 1) != 0) {                                       \
+		return;                                                          \
+	}                                                                        \
+	s->items[s->len++] = val;                                                \
+	name##_index_append(s, s->len - 1, 1);                                   \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_reverse(name##_t *s)                                                      \
+{                                                                                \
+	if (s->len < 2) {                                                        \
+		return;                                                          \
+	}                                                                        \
+	s->sorted = false;                                                       \
+                                                                                 \
+	uint64_t i = s->len - 1;                                                 \
+	uint64_t j = 0;                                                          \
+                                                                                 \
+	while (i > j) {                                                          \
+		T temp = s->items[i];                                            \
+		s->items[i] = s->items[j];                                       \
+		s->items[j] = temp;                                              \
+		i--;                                                             \
+		j++;                                                             \
+	}                                                                        \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_compare(const name##_t *s1, const name##_t *s2, name##_compare_func_t compare, void *user_data) \
+{                                                                                \
+	return name##_view_compare(name##_as_view(s1), name##_as_view(s2), compare, user_data); \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_copy(const name##_t *s1, name##_t *s2, bool overwrite)                    \
+{                                                                                \
+	uint64_t n = s1->len < s2->len ? s1->len : s2->len;                      \
+                                                                                 \
+	if (s1 == s2) {                                                          \
+		return n;                                                        \
+	}                                                                        \
+	if (overwrite) {                                                         \
+		if (s1->len > s2->cap && name##_resize(s2, s1->len) != 0) {      \
+			return 0;                                                \
+		}                                                                \
+		n = s1->len;                                                     \
+		s2->len = n;                                                     \
+	}                                                                        \
+                                                                                 \
+	/**                                                                      \
+	 * s2 is only known to be sorted if all of its items now come from a     \
+	 * sorted s1, a prefix of sorted items being sorted too.                 \
+	 */                                                                      \
+	if (n > 0) {                                                             \
+		memcpy(s2->items, s1->items, sizeof(T) * n);                     \
+	}                                                                        \
+	s2->sorted = s1->sorted && n == s2->len;                                 \
+	if (s2->index != NULL) {                                                 \
+		name##_index_rebuild(s2);                                        \
+	}                                                                        \
+                                                                                 \
+	return n;                                                                \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_contains(const name##_t *s, const T val)                                  \
+{                                                                                \
+	const slice_index_t *ix = name##_index_ready(s);                         \
+                                                                                 \
+	if (ix != NULL) {                                                        \
+		return name##_items_index_count(ix, val) != 0;                   \
+	}                                                                        \
+                                                                                 \
+	return name##_index_of(s, val) != -1;                                    \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_index_of(const name##_t *s, const T val)                                  \
+{                                                                                \
+	const slice_index_t *ix = name##_index_ready(s);                         \
+                                                                                 \
+	if (ix != NULL && name##_items_index_count(ix, val) == 0) {              \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	if (name##_bsearchable(s)) {                                             \
+		uint64_t idx = name##_items_lower_bound(s->items, s->len, val);  \
+		if (idx == s->len || !name##_item_eq(s->items[idx], val)) {      \
+			return -1;                                               \
+		}                                                                \
+		return (int64_t)idx;                                             \
+	}                                                                        \
+                                                                                 \
+	return name##_view_index_of(name##_as_view(s), val);                     \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_delete(name##_t *s, const uint64_t idx)                                   \
+{                                                                                \
+	if (idx >= s->len) {                                                     \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	name##_index_drop(s, s->items[idx], 1);                                  \
+	memmove(s->items + idx, s->items + idx + 1, sizeof(T) * (s->len - idx - 1)); \
+	s->len--;                                                                \
+                                                                                 \
+	return s->len;                                                           \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_swap_remove(name##_t *s, const uint64_t idx)                              \
+{                                                                                \
+	if (idx >= s->len) {                                                     \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	name##_index_drop(s, s->items[idx], 1);                                  \
+	s->len--;                                                                \
+	if (idx != s->len) {                                                     \
+		s->items[idx] = s->items[s->len];                                \
+		s->sorted = false;                                               \
+	}                                                                        \
+                                                                                 \
+	return (int64_t)s->len;                                                  \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_delete_indices(name##_t *s, const size_t *idx, const size_t n)            \
+{                                                                                \
+	uint64_t j;                                                              \
+                                                                                 \
+	if (n == 0) {                                                            \
+		return (int64_t)s->len;                                          \
+	}                                                                        \
+	for (size_t k = 0; k < n; k++) {                                         \
+		if (idx[k] >= s->len || (k > 0 && idx[k] < idx[k - 1])) {        \
+			return -1;                                               \
+		}                                                                \
+	}                                                                        \
+	for (size_t k = 0; k < n; k++) {                                         \
+		if (k == 0 || idx[k] != idx[k - 1]) {                            \
+			name##_index_drop(s, s->items[idx[k]], 1);               \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	/**                                                                      \
+	 * j is where the run of items after each index is moved to.             \
+	 */                                                                      \
+	j = idx[0];                                                              \
+	for (size_t k = 0; k < n; k++) {                                         \
+		uint64_t lo = idx[k] + 1;                                        \
+		uint64_t hi = k + 1 < n ? idx[k + 1] : s->len;                   \
+                                                                                 \
+		if (lo > hi) {                                                   \
+			continue;                                                \
+		}                                                                \
+		memmove(s->items + j, s->items + lo, sizeof(T) * (hi - lo));     \
+		j += hi - lo;                                                    \
+	}                                                                        \
+	s->len = j;                                                              \
+                                                                                 \
+	return (int64_t)s->len;                                                  \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_retain(name##_t *s, name##_pred_func_t pred, void *user_data)             \
+{                                                                                \
+	uint64_t i = 0;                                                          \
+                                                                                 \
+	while (i < s->len && pred(s->items[i], user_data)) {                     \
+		i++;                                                             \
+	}                                                                        \
+	if (i == s->len) {                                                       \
+		return s->len;                                                   \
+	}                                                                        \
+                                                                                 \
+	uint64_t j = i;                                                          \
+	name##_index_drop(s, s->items[i], 1);                                    \
+	for (i++; i < s->len; i++) {                                             \
+		T x = s->items[i];                                               \
+		if (pred(x, user_data)) {                                        \
+			s->items[j++] = x;                                       \
+		} else {                                                         \
+			name##_index_drop(s, x, 1);                              \
+		}                                                                \
+	}                                                                        \
+	s->len = j;                                                              \
+                                                                                 \
+	return s->len;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_remove_value(name##_t *s, const T val)                                    \
+{                                                                                \
+	uint64_t len = name##_items_remove(s->items, s->len, val);               \
+                                                                                 \
+	if (len != s->len) {                                                     \
+		name##_index_drop(s, val, s->len - len);                         \
+		s->len = len;                                                    \
+	}                                                                        \
+                                                                                 \
+	return s->len;                                                           \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_replace_by_idx(name##_t *s, const uint64_t idx, const T val)              \
+{                                                                                \
+	if (idx >= s->len) {                                                     \
+		return -1;                                                       \
+	}                                                                        \
+	name##_index_drop(s, s->items[idx], 1);                                  \
+	s->items[idx] = val;                                                     \
+	s->sorted = false;                                                       \
+	name##_index_put(s, val, 1);                                             \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_replace_by_val(name##_t *s, const T old_val, const T new_val, uint64_t times, name##_compare_func_t compare) \
+{                                                                                \
+	if (s->len == 0) {                                                       \
+		return -1;                                                       \
+	}                                                                        \
+	s->sorted = false;                                                       \
+                                                                                 \
+	if (compare == NULL && times >= s->len) {                                \
+		/**                                                              \
+		 * replacing every occurrence needs no early exit, write each item \
+		 * back unconditionally so the loop compiles to compare and blend. \
+		 * An up to date index already knows how many there are.         \
+		 */                                                              \
+		const uint64_t hits = slice_index_live(s->index) ? name##_items_index_count(s->index, old_val) : 0; \
+		T *items = s->items;                                             \
+		for (uint64_t i = 0; i < s->len; i++) {                          \
+			items[i] = name##_item_eq(items[i], old_val) ? new_val : items[i]; \
+		}                                                                \
+		name##_index_drop(s, old_val, hits);                             \
+		name##_index_put(s, new_val, hits);                              \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	uint64_t replaced = 0;                                                   \
+	for (uint64_t i = 0; i < s->len && times != 0; i++) {                    \
+		if (compare == NULL ? name##_item_eq(s->items[i], old_val) : compare(s->items[i], old_val, NULL)) { \
+			name##_index_drop(s, s->items[i], 1);                    \
+			s->items[i] = new_val;                                   \
+			replaced++;                                              \
+			times--;                                                 \
+		}                                                                \
+	}                                                                        \
+	name##_index_put(s, new_val, replaced);                                  \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_first(name##_t *s)                                                        \
+{                                                                                \
+	return name##_get(s, 0);                                                 \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_last(name##_t *s)                                                         \
+{                                                                                \
+	return name##_get(s, s->len - 1);                                        \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_foreach(name##_t *s, name##_foreach_func_t ift, void *user_data)          \
+{                                                                                \
+	return name##_view_foreach(name##_as_view(s), ift, user_data);           \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_foreach_block(const name##_t *s, name##_block_func_t fn, void *user_data) \
+{                                                                                \
+	return name##_view_foreach_block(name##_as_view(s), fn, user_data);      \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_transform(name##_t *s, name##_transform_func_t fn, void *user_data)       \
+{                                                                                \
+	s->sorted = false;                                                       \
+	int ret = name##_view_transform(name##_as_view(s), fn, user_data);       \
+	if (s->index != NULL) {                                                  \
+		name##_index_rebuild(s);                                         \
+	}                                                                        \
+                                                                                 \
+	return ret;                                                              \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_map_into(const name##_t *s, name##_t *dst, name##_map_func_t fn, void *user_data) \
+{                                                                                \
+	const uint64_t block = name##_block_items();                             \
+	const uint64_t n = s->len;                                               \
+                                                                                 \
+	if (n > dst->cap && name##_resize(dst, n) != 0) {                        \
+		return dst->len;                                                 \
+	}                                                                        \
+                                                                                 \
+	for (uint64_t i = 0; i < n; i += block) {                                \
+		fn(s->items + i, dst->items + i, n - i < block ? n - i : block, user_data); \
+	}                                                                        \
+	dst->len = n;                                                            \
+	dst->sorted = false;                                                     \
+	if (dst->index != NULL) {                                                \
+		name##_index_rebuild(dst);                                       \
+	}                                                                        \
+                                                                                 \
+	return dst->len;                                                         \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_sort(name##_t *s, sort_compare_func_t sort_compare)                       \
+{                                                                                \
+	if (sort_compare == NULL) {                                              \
+		s->sorted = name##_items_sort(s->items, s->len, s->allocator);   \
+		return;                                                          \
+	}                                                                        \
+	name##_view_sort(name##_as_view(s), sort_compare);                       \
+	s->sorted = false;                                                       \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_repeat(name##_t *s, const T val, const uint64_t times)                    \
+{                                                                                \
+	if (name##_make_room(s, times) != 0) {                                   \
+		return s->len;                                                   \
+	}                                                                        \
+                                                                                 \
+	T *items = s->items + s->len;                                            \
+	for (uint64_t i = 0; i < times; i++) {                                   \
+		items[i] = val;                                                  \
+	}                                                                        \
+	s->len += times;                                                         \
+	s->sorted = false;                                                       \
+	name##_index_put(s, val, times);                                         \
+                                                                                 \
+	return s->len;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_count(name##_t *s, const T val, name##_compare_func_t compare)            \
+{                                                                                \
+	const slice_index_t *ix = compare == NULL ? name##_index_ready(s) : NULL; \
+                                                                                 \
+	if (ix != NULL) {                                                        \
+		return name##_items_index_count(ix, val);                        \
+	}                                                                        \
+                                                                                 \
+	if (compare == NULL && name##_bsearchable(s)) {                          \
+		return name##_items_upper_bound(s->items, s->len, val) -         \
+		    name##_items_lower_bound(s->items, s->len, val);             \
+	}                                                                        \
+                                                                                 \
+	return name##_view_count(name##_as_view(s), val, compare);               \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_grow(name##_t *s, const uint64_t size)                                    \
+{                                                                                \
+	if (size == 0) {                                                         \
+		return s->cap;                                                   \
+	}                                                                        \
+                                                                                 \
+	name##_resize(s, s->cap + size);                                         \
+                                                                                 \
+	return s->cap;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_concat(name##_t *s1, const name##_t *s2)                                  \
+{                                                                                \
+	return name##_append_slice(s1, s2);                                      \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_append_n(name##_t *s, const T *buf, const uint64_t n)                     \
+{                                                                                \
+	if (n == 0) {                                                            \
+		return s->len;                                                   \
+	}                                                                        \
+                                                                                 \
+	if (name##_make_room(s, n) != 0) {                                       \
+		return s->len;                                                   \
+	}                                                                        \
+                                                                                 \
+	memcpy(s->items + s->len, buf, sizeof(T) * n);                           \
+	s->len += n;                                                             \
+	s->sorted = false;                                                       \
+	name##_index_append(s, s->len - n, n);                                   \
+                                                                                 \
+	return s->len;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_append_slice(name##_t *s1, const name##_t *s2)                            \
+{                                                                                \
+	uint64_t n = s2->len;                                                    \
+                                                                                 \
+	if (n == 0) {                                                            \
+		return s1->len;                                                  \
+	}                                                                        \
+                                                                                 \
+	/**                                                                      \
+	 * s2 may be s1, so its items are only read after s1 has been resized.   \
+	 */                                                                      \
+	if (name##_make_room(s1, n) != 0) {                                      \
+		return s1->len;                                                  \
+	}                                                                        \
+                                                                                 \
+	memcpy(s1->items + s1->len, s2->items, sizeof(T) * n);                   \
+	s1->len += n;                                                            \
+	s1->sorted = false;                                                      \
+	name##_index_append(s1, s1->len - n, n);                                 \
+                                                                                 \
+	return s1->len;                                                          \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_insert(name##_t *s, const uint64_t idx, const T val)                      \
+{                                                                                \
+	if (idx > s->len || name##_make_room(s, 1) != 0) {                       \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	s->sorted = s->sorted &&                                                 \
+	    (idx == 0 || !name##_item_lt(val, s->items[idx - 1])) &&             \
+	    (idx == s->len || !name##_item_lt(s->items[idx], val));              \
+	memmove(s->items + idx + 1, s->items + idx, sizeof(T) * (s->len - idx)); \
+	s->items[idx] = val;                                                     \
+	s->len++;                                                                \
+	name##_index_append(s, idx, 1);                                          \
+                                                                                 \
+	return (int64_t)s->len;                                                  \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_insert_n(name##_t *s, const uint64_t idx, const T *buf, const uint64_t n) \
+{                                                                                \
+	if (idx > s->len || name##_make_room(s, n) != 0) {                       \
+		return -1;                                                       \
+	}                                                                        \
+	if (n == 0) {                                                            \
+		return (int64_t)s->len;                                          \
+	}                                                                        \
+                                                                                 \
+	memmove(s->items + idx + n, s->items + idx, sizeof(T) * (s->len - idx)); \
+	memcpy(s->items + idx, buf, sizeof(T) * n);                              \
+	s->len += n;                                                             \
+	s->sorted = false;                                                       \
+	name##_index_append(s, idx, n);                                          \
+                                                                                 \
+	return (int64_t)s->len;                                                  \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_fill(name##_t *s, const T val, const uint64_t n)                          \
+{                                                                                \
+	s->len = 0;                                                              \
+	if (s->index != NULL) {                                                  \
+		name##_index_rebuild(s);                                         \
+	}                                                                        \
+                                                                                 \
+	return name##_repeat(s, val, n);                                         \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_set_growth(name##_t *s, const slice_growth_t growth)                      \
+{                                                                                \
+	s->growth = growth;                                                      \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_reserve(name##_t *s, const uint64_t n)                                    \
+{                                                                                \
+	if (n > s->cap) {                                                        \
+		name##_resize(s, n);                                             \
+	}                                                                        \
+                                                                                 \
+	return s->cap;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_shrink_to_fit(name##_t *s)                                                \
+{                                                                                \
+	if (s->len == s->cap || s->items == s->inline_items) {                   \
+		return s->cap;                                                   \
+	}                                                                        \
+                                                                                 \
+	if (s->len == 0) {                                                       \
+		slice_free(s->allocator, s->items);                              \
+		s->items = NULL;                                                 \
+		s->cap = 0;                                                      \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	name##_resize(s, s->len);                                                \
+                                                                                 \
+	return s->cap;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_reallocs(const name##_t *s)                                               \
+{                                                                                \
+	return s->reallocs;                                                      \
+}                                                                                \
+                                                                                 \
+name##_view_t                                                                    \
+name##_as_view(const name##_t *s)                                                \
+{                                                                                \
+	name##_view_t v = {s->items, s->len};                                    \
+                                                                                 \
+	return v;                                                                \
+}                                                                                \
+                                                                                 \
+name##_view_t                                                                    \
+name##_view(const name##_t *s, const uint64_t lo, const uint64_t hi)             \
+{                                                                                \
+	return name##_view_sub(name##_as_view(s), lo, hi);                       \
+}                                                                                \
+                                                                                 \
+name##_view_t                                                                    \
+name##_view_sub(const name##_view_t v, const uint64_t lo, const uint64_t hi)     \
+{                                                                                \
+	name##_view_t sub = {NULL, 0};                                           \
+                                                                                 \
+	if (lo > hi || hi > v.len) {                                             \
+		return sub;                                                      \
+	}                                                                        \
+	sub.items = v.items + lo;                                                \
+	sub.len = hi - lo;                                                       \
+                                                                                 \
+	return sub;                                                              \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_view_get(const name##_view_t v, const uint64_t idx)                       \
+{                                                                                \
+	if (SLICE_IN_BOUNDS(idx, v.len)) {                                       \
+		return v.items[idx];                                             \
+	}                                                                        \
+                                                                                 \
+	return (T){0};                                                           \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_view_contains(const name##_view_t v, const T val)                         \
+{                                                                                \
+	return name##_items_find(v.items, v.len, val) != v.len;                  \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_view_index_of(const name##_view_t v, const T val)                         \
+{                                                                                \
+	uint64_t idx = name##_items_find(v.items, v.len, val);                   \
+	if (idx == v.len) {                                                      \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	return (int64_t)idx;                                                     \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_view_count(const name##_view_t v, const T val, name##_compare_func_t compare) \
+{                                                                                \
+	uint64_t count = 0;                                                      \
+                                                                                 \
+	if (compare == NULL) {                                                   \
+		return name##_items_count(v.items, v.len, val);                  \
+	}                                                                        \
+                                                                                 \
+	for (uint64_t i = 0; i < v.len; i++) {                                   \
+		if (compare(v.items[i], val, NULL)) {                            \
+			count++;                                                 \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return count;                                                            \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_view_foreach(const name##_view_t v, name##_foreach_func_t ift, void *user_data) \
+{                                                                                \
+	for (uint64_t i = 0; i < v.len; i++) {                                   \
+		ift(v.items[i], user_data);                                      \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_view_foreach_block(const name##_view_t v, name##_block_func_t fn, void *user_data) \
+{                                                                                \
+	const uint64_t block = name##_block_items();                             \
+                                                                                 \
+	for (uint64_t i = 0; i < v.len; i += block) {                            \
+		fn(v.items + i, v.len - i < block ? v.len - i : block, user_data); \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_view_transform(const name##_view_t v, name##_transform_func_t fn, void *user_data) \
+{                                                                                \
+	const uint64_t block = name##_block_items();                             \
+                                                                                 \
+	for (uint64_t i = 0; i < v.len; i += block) {                            \
+		fn(v.items + i, v.len - i < block ? v.len - i : block, user_data); \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_view_compare(const name##_view_t v1, const name##_view_t v2, name##_compare_func_t compare, void *user_data) \
+{                                                                                \
+	if (v1.len != v2.len) {                                                  \
+		return false;                                                    \
+	}                                                                        \
+                                                                                 \
+	if (compare == NULL) {                                                   \
+		return v1.len == 0 || memcmp(v1.items, v2.items, sizeof(T) * v1.len) == 0; \
+	}                                                                        \
+                                                                                 \
+	for (uint64_t i = 0; i < v1.len; i++) {                                  \
+		if (!compare(v1.items[i], v2.items[i], user_data)) {             \
+			return false;                                            \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return true;                                                             \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_view_sort(const name##_view_t v, sort_compare_func_t sort_compare)        \
+{                                                                                \
+	if (v.len < 2) {                                                         \
+		return;                                                          \
+	}                                                                        \
+                                                                                 \
+	if (sort_compare == NULL) {                                              \
+		(void)name##_items_sort(v.items, v.len, NULL);                   \
+		return;                                                          \
+	}                                                                        \
+                                                                                 \
+	qsort(v.items, v.len, sizeof(T), sort_compare);                          \
+}
+
+/**
+ * SLICE_DEFINE and SLICE_DEFINE_INT define the functions of a type made
+ * with SLICE_DECLARE.
+ */
+#define SLICE_DEFINE(name, T)                                                    \
+SLICE_KERNELS(name, T)                                                           \
+SLICE_DEFINE_FUNCS(name, T)
+
+#define SLICE_DEFINE_INT(name, T)                                                \
+SLICE_KERNELS_INT(name, T)                                                       \
+SLICE_DEFINE_FUNCS(name, T)
+
+/**
+ * SLICE_DEFINE_OPAQUE and SLICE_DEFINE_OPAQUE_INT define the struct and
+ * all functions, fast paths included, of a type made with
+ * SLICE_DECLARE_OPAQUE.
+ */
+#define SLICE_DEFINE_OPAQUE(name, T)                                             \
+SLICE_STRUCT(name, T)                                                            \
+SLICE_FAST_PATHS(name, T, )                                                      \
+SLICE_DEFINE(name, T)
+
+#define SLICE_DEFINE_OPAQUE_INT(name, T)                                         \
+SLICE_STRUCT(name, T)                                                            \
+SLICE_FAST_PATHS(name, T, )                                                      \
+SLICE_DEFINE_INT(name, T)
+
+/**
+ * SLICE_DECLARE_REDUCE declares the reductions of a slice of integers.
+ * Sums are returned as W, int64_t for signed items and uint64_t for
+ * unsigned ones, so items narrower than 64 bits can't overflow them.
+ */
+#define SLICE_DECLARE_REDUCE(name, T, W)                                         \
+/**                                                                              \
+ * name_sum returns the sum of the items, wrapping if it doesn't fit in W.       \
+ */                                                                              \
+W                                                                                \
+name##_sum(const name##_t *s);                                                   \
+                                                                                 \
+/**                                                                              \
+ * name_sum_checked stores the sum of the items in sum and returns true if       \
+ * it fits in W. Otherwise the wrapped sum is stored and false returned.         \
+ */                                                                              \
+bool                                                                             \
+name##_sum_checked(const name##_t *s, W *sum);                                   \
+                                                                                 \
+/**                                                                              \
+ * name_sum_saturating returns the sum of the items, clamped to the range        \
+ * of W.                                                                         \
+ */                                                                              \
+W                                                                                \
+name##_sum_saturating(const name##_t *s);                                        \
+                                                                                 \
+/**                                                                              \
+ * name_min returns the smallest item, or 0 if the slice is empty.               \
+ */                                                                              \
+T                                                                                \
+name##_min(const name##_t *s);                                                   \
+                                                                                 \
+/**                                                                              \
+ * name_max returns the largest item, or 0 if the slice is empty.                \
+ */                                                                              \
+T                                                                                \
+name##_max(const name##_t *s);                                                   \
+                                                                                 \
+/**                                                                              \
+ * name_minmax stores the smallest and largest item in min and max, found        \
+ * in a single pass, and returns false if the slice is empty.                    \
+ */                                                                              \
+bool                                                                             \
+name##_minmax(const name##_t *s, T *min, T *max);                                \
+                                                                                 \
+/**                                                                              \
+ * name_view_sum returns the sum of the items of the view.                       \
+ */                                                                              \
+W                                                                                \
+name##_view_sum(const name##_view_t v);                                          \
+                                                                                 \
+/**                                                                              \
+ * name_view_minmax is name_minmax for a view.                                   \
+ */                                                                              \
+bool                                                                             \
+name##_view_minmax(const name##_view_t v, T *min, T *max);
+
+/**
+ * SLICE_DEFINE_REDUCE defines the reductions declared by
+ * SLICE_DECLARE_REDUCE on top of the vector kernels of slice_simd.h. It
+ * has to follow the definition of the slice.
+ */
+#define SLICE_DEFINE_REDUCE(name, T, W)                                          \
+W                                                                                \
+name##_sum(const name##_t *s)                                                    \
+{                                                                                \
+	return name##_view_sum(name##_as_view(s));                               \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_sum_checked(const name##_t *s, W *sum)                                    \
+{                                                                                \
+	uint64_t hi;                                                             \
+	uint64_t lo = slice_simd_sum_exact(s->items, s->len, sizeof(T), SLICE_IS_SIGNED(T), &hi); \
+                                                                                 \
+	*sum = (W)lo;                                                            \
+	if (SLICE_IS_SIGNED(T)) {                                                \
+		return hi == ((lo >> 63) != 0 ? UINT64_MAX : 0);                 \
+	}                                                                        \
+                                                                                 \
+	return hi == 0;                                                          \
+}                                                                                \
+                                                                                 \
+W                                                                                \
+name##_sum_saturating(const name##_t *s)                                         \
+{                                                                                \
+	uint64_t hi;                                                             \
+	uint64_t lo = slice_simd_sum_exact(s->items, s->len, sizeof(T), SLICE_IS_SIGNED(T), &hi); \
+                                                                                 \
+	if (!SLICE_IS_SIGNED(T)) {                                               \
+		return (W)(hi == 0 ? lo : UINT64_MAX);                           \
+	}                                                                        \
+	if (hi == ((lo >> 63) != 0 ? UINT64_MAX : 0)) {                          \
+		return (W)lo;                                                    \
+	}                                                                        \
+                                                                                 \
+	return (W)((hi >> 63) != 0 ? (uint64_t)1 << 63 : UINT64_MAX >> 1);       \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_min(const name##_t *s)                                                    \
+{                                                                                \
+	T min = 0;                                                               \
+	T max = 0;                                                               \
+                                                                                 \
+	name##_minmax(s, &min, &max);                                            \
+                                                                                 \
+	return min;                                                              \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_max(const name##_t *s)                                                    \
+{                                                                                \
+	T min = 0;                                                               \
+	T max = 0;                                                               \
+                                                                                 \
+	name##_minmax(s, &min, &max);                                            \
+                                                                                 \
+	return max;                                                              \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_minmax(const name##_t *s, T *min, T *max)                                 \
+{                                                                                \
+	return name##_view_minmax(name##_as_view(s), min, max);                  \
+}                                                                                \
+                                                                                 \
+W                                                                                \
+name##_view_sum(const name##_view_t v)                                           \
+{                                                                                \
+	return (W)slice_simd_sum(v.items, v.len, sizeof(T), SLICE_IS_SIGNED(T)); \
+}                                                                                \
+                                                                                 \
+bool                                                                             \
+name##_view_minmax(const name##_view_t v, T *min, T *max)                        \
+{                                                                                \
+	if (v.len == 0) {                                                        \
+		return false;                                                    \
+	}                                                                        \
+	slice_simd_minmax(v.items, v.len, sizeof(T), SLICE_IS_SIGNED(T), min, max); \
+                                                                                 \
+	return true;                                                             \
+}
+
+/**
+ * SLICE_DECLARE_SORTED declares the searches and inserts of a slice of
+ * integers kept in ascending order. The searches assume that order
+ * whether or not the slice is marked sorted.
+ */
+#define SLICE_DECLARE_SORTED(name, T)                                            \
+/**                                                                              \
+ * name_is_sorted returns true if the slice is known to be in ascending          \
+ * order, which makes contains, index_of and count binary search it.             \
+ */                                                                              \
+bool                                                                             \
+name##_is_sorted(const name##_t *s);                                             \
+                                                                                 \
+/**                                                                              \
+ * name_set_sorted marks the slice as being in ascending order or not, for       \
+ * items put in order without name_sort or modified through a view. Marking      \
+ * a slice sorted that isn't makes its searches miss items.                      \
+ */                                                                              \
+void                                                                             \
+name##_set_sorted(name##_t *s, const bool sorted);                               \
+                                                                                 \
+/**                                                                              \
+ * name_lower_bound returns the index of the first item not less than val,       \
+ * or the length of the slice if there's none.                                   \
+ */                                                                              \
+uint64_t                                                                         \
+name##_lower_bound(const name##_t *s, const T val);                              \
+                                                                                 \
+/**                                                                              \
+ * name_upper_bound returns the index of the first item greater than val,        \
+ * or the length of the slice if there's none.                                   \
+ */                                                                              \
+uint64_t                                                                         \
+name##_upper_bound(const name##_t *s, const T val);                              \
+                                                                                 \
+/**                                                                              \
+ * name_equal_range returns a view over the items equal to val, empty if         \
+ * there are none.                                                               \
+ */                                                                              \
+name##_view_t                                                                    \
+name##_equal_range(const name##_t *s, const T val);                              \
+                                                                                 \
+/**                                                                              \
+ * name_insert_sorted inserts val after any items equal to it, keeping the       \
+ * slice in order, and returns its index or -1 if the slice couldn't grow.       \
+ * It grows the slice at most once and moves the later items with a single       \
+ * memmove. Whether the slice is marked sorted is left as it was.                \
+ */                                                                              \
+int64_t                                                                          \
+name##_insert_sorted(name##_t *s, const T val);                                  \
+                                                                                 \
+/**                                                                              \
+ * name_view_lower_bound is name_lower_bound for a view.                         \
+ */                                                                              \
+uint64_t                                                                         \
+name##_view_lower_bound(const name##_view_t v, const T val);                     \
+                                                                                 \
+/**                                                                              \
+ * name_view_upper_bound is name_upper_bound for a view.                         \
+ */                                                                              \
+uint64_t                                                                         \
+name##_view_upper_bound(const name##_view_t v, const T val);
+
+/**
+ * SLICE_DEFINE_SORTED defines the functions declared by
+ * SLICE_DECLARE_SORTED. It has to follow the definition of the slice.
+ */
+#define SLICE_DEFINE_SORTED(name, T)                                             \
+bool                                                                             \
+name##_is_sorted(const name##_t *s)                                              \
+{                                                                                \
+	return s->sorted;                                                        \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_set_sorted(name##_t *s, const bool sorted)                                \
+{                                                                                \
+	s->sorted = sorted;                                                      \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_lower_bound(const name##_t *s, const T val)                               \
+{                                                                                \
+	return name##_items_lower_bound(s->items, s->len, val);                  \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_upper_bound(const name##_t *s, const T val)                               \
+{                                                                                \
+	return name##_items_upper_bound(s->items, s->len, val);                  \
+}                                                                                \
+                                                                                 \
+name##_view_t                                                                    \
+name##_equal_range(const name##_t *s, const T val)                               \
+{                                                                                \
+	uint64_t lo = name##_items_lower_bound(s->items, s->len, val);           \
+	uint64_t hi = lo + name##_items_upper_bound(s->items + lo, s->len - lo, val); \
+                                                                                 \
+	return name##_view(s, lo, hi);                                           \
+}                                                                                \
+                                                                                 \
+int64_t                                                                          \
+name##_insert_sorted(name##_t *s, const T val)                                   \
+{                                                                                \
+	uint64_t idx = name##_items_upper_bound(s->items, s->len, val);          \
+                                                                                 \
+	if (name##_make_room(s, 1) != 0) {                                       \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	memmove(s->items + idx + 1, s->items + idx, sizeof(T) * (s->len - idx)); \
+	s->items[idx] = val;                                                     \
+	s->len++;                                                                \
+	name##_index_append(s, idx, 1);                                          \
+                                                                                 \
+	return (int64_t)idx;                                                     \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_view_lower_bound(const name##_view_t v, const T val)                      \
+{                                                                                \
+	return name##_items_lower_bound(v.items, v.len, val);                    \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_view_upper_bound(const name##_view_t v, const T val)                      \
+{                                                                                \
+	return name##_items_upper_bound(v.items, v.len, val);                    \
+}
+
+/**
+ * SLICE_DECLARE_INDEX declares the hash index of a slice of integers, for
+ * slices queried with contains and count far more often than they change
+ * and that can't be kept sorted.
+ */
+#define SLICE_DECLARE_INDEX(name, T)                                             \
+/**                                                                              \
+ * name_index_enable attaches a hash index to the slice and builds it,           \
+ * making contains, count and index_of constant time lookups. The calls          \
+ * that write items keep it up to date: appends and inserts add their            \
+ * items, delete, the removes and the replaces take out the items they           \
+ * drop, and calls that rewrite most of the slice, like fill or transform,       \
+ * rebuild it. Sorting doesn't touch it. Queries never write to the index,       \
+ * so an indexed slice can be read from several threads at once as long as       \
+ * none of them writes to it. Returns -1 if the index can't be allocated         \
+ * or built.                                                                     \
+ */                                                                              \
+int                                                                              \
+name##_index_enable(name##_t *s);                                                \
+                                                                                 \
+/**                                                                              \
+ * name_index_build brings a stale hash index up to date with the items,         \
+ * after writes through a view or name_data_mut, or an index that couldn't       \
+ * grow. Returns -1 if the slice has no index or it can't be built, in           \
+ * which case it stays stale.                                                    \
+ */                                                                              \
+int                                                                              \
+name##_index_build(name##_t *s);                                                 \
+                                                                                 \
+/**                                                                              \
+ * name_index_disable frees the slice's hash index, if it has one.               \
+ */                                                                              \
+void                                                                             \
+name##_index_disable(name##_t *s);                                               \
+                                                                                 \
+/**                                                                              \
+ * name_index_invalidate marks the hash index stale, for items changed           \
+ * through a view or the pointer returned by name_data_mut after the call.       \
+ * Queries search the items until name_index_build.                              \
+ */                                                                              \
+void                                                                             \
+name##_index_invalidate(name##_t *s);                                            \
+                                                                                 \
+/**                                                                              \
+ * name_index_bytes returns the memory used by the slice's hash index, 0 if      \
+ * it has none. The index holds a table of 16 byte entries for the               \
+ * distinct items of the slice, kept at most 3/4 full.                           \
+ */                                                                              \
+uint64_t                                                                         \
+name##_index_bytes(const name##_t *s);
+
+/**
+ * SLICE_DEFINE_INDEX defines the functions declared by
+ * SLICE_DECLARE_INDEX. It has to follow the definition of the slice.
+ */
+#define SLICE_DEFINE_INDEX(name, T)                                              \
+int                                                                              \
+name##_index_enable(name##_t *s)                                                 \
+{                                                                                \
+	if (s->index == NULL) {                                                  \
+		s->index = slice_index_new(s->allocator, false);                 \
+		if (s->index == NULL) {                                          \
+			return -1;                                               \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return name##_index_build(s);                                            \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_index_build(name##_t *s)                                                  \
+{                                                                                \
+	slice_index_t *ix = s->index;                                            \
+                                                                                 \
+	if (ix == NULL) {                                                        \
+		return -1;                                                       \
+	}                                                                        \
+	if (ix->valid) {                                                         \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	return name##_index_rebuild(s);                                          \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_index_disable(name##_t *s)                                                \
+{                                                                                \
+	slice_index_free(s->index);                                              \
+	s->index = NULL;                                                         \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_index_invalidate(name##_t *s)                                             \
+{                                                                                \
+	slice_index_invalidate(s->index);                                        \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_index_bytes(const name##_t *s)                                            \
+{                                                                                \
+	return slice_index_bytes(s->index);                                      \
+}
+
+/**
+ * SLICE_DECLARE_DEQUE declares name_deque_t, a double ended queue of items
+ * of type T kept in a ring buffer. Items are pushed and popped at either
+ * end in constant time, where a slice used as a queue moves all of its
+ * items on every name_delete(s, 0). The items wrap around the end of the
+ * buffer, so they're handed out for bulk access as up to two views by
+ * name_deque_segments. The capacity is a power of 2 and doubles when the
+ * deque is full. It has to follow the declaration of the slice.
+ */
+#define SLICE_DECLARE_DEQUE(name, T)                                             \
+typedef struct name##_deque name##_deque_t;                                      \
+                                                                                 \
+/**                                                                              \
+ * name_deque_new creates an empty deque with room for at least cap items.       \
+ * Returns NULL if the allocation fails.                                         \
+ */                                                                              \
+name##_deque_t*                                                                  \
+name##_deque_new(const uint64_t cap);                                            \
+                                                                                 \
+/**                                                                              \
+ * name_deque_new_with_allocator is name_deque_new taking all of its             \
+ * memory from the given allocator.                                              \
+ */                                                                              \
+name##_deque_t*                                                                  \
+name##_deque_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator); \
+                                                                                 \
+/**                                                                              \
+ * name_deque_free frees the deque and its items.                                \
+ */                                                                              \
+void                                                                             \
+name##_deque_free(name##_deque_t *d);                                            \
+                                                                                 \
+/**                                                                              \
+ * name_deque_len returns the number of items in the deque.                      \
+ */                                                                              \
+uint64_t                                                                         \
+name##_deque_len(const name##_deque_t *d);                                       \
+                                                                                 \
+/**                                                                              \
+ * name_deque_cap returns the number of items the deque holds before it          \
+ * has to grow.                                                                  \
+ */                                                                              \
+uint64_t                                                                         \
+name##_deque_cap(const name##_deque_t *d);                                       \
+                                                                                 \
+/**                                                                              \
+ * name_deque_reserve makes sure n items fit without growing and returns         \
+ * the capacity.                                                                 \
+ */                                                                              \
+uint64_t                                                                         \
+name##_deque_reserve(name##_deque_t *d, const uint64_t n);                       \
+                                                                                 \
+/**                                                                              \
+ * name_deque_push_back adds val after the last item. Returns -1 if the          \
+ * deque couldn't grow.                                                          \
+ */                                                                              \
+int                                                                              \
+name##_deque_push_back(name##_deque_t *d, const T val);                          \
+                                                                                 \
+/**                                                                              \
+ * name_deque_push_front adds val before the first item. Returns -1 if the       \
+ * deque couldn't grow.                                                          \
+ */                                                                              \
+int                                                                              \
+name##_deque_push_front(name##_deque_t *d, const T val);                         \
+                                                                                 \
+/**                                                                              \
+ * name_deque_pop_front removes the first item and stores it in val, which       \
+ * may be NULL. Returns -1 if the deque is empty.                                \
+ */                                                                              \
+int                                                                              \
+name##_deque_pop_front(name##_deque_t *d, T *val);                               \
+                                                                                 \
+/**                                                                              \
+ * name_deque_pop_back removes the last item and stores it in val, which         \
+ * may be NULL. Returns -1 if the deque is empty.                                \
+ */                                                                              \
+int                                                                              \
+name##_deque_pop_back(name##_deque_t *d, T *val);                                \
+                                                                                 \
+/**                                                                              \
+ * name_deque_push_back_n adds the n items of buf after the last item,           \
+ * growing the deque at most once and copying them with at most two              \
+ * memcpy. Returns -1 if the deque couldn't grow.                                \
+ */                                                                              \
+int                                                                              \
+name##_deque_push_back_n(name##_deque_t *d, const T *buf, const uint64_t n);     \
+                                                                                 \
+/**                                                                              \
+ * name_deque_pop_front_n removes up to n items from the front into buf,         \
+ * with at most two memcpy, and returns how many were removed.                   \
+ */                                                                              \
+uint64_t                                                                         \
+name##_deque_pop_front_n(name##_deque_t *d, T *buf, const uint64_t n);           \
+                                                                                 \
+/**                                                                              \
+ * name_deque_front returns the first item, or 0 if the deque is empty.          \
+ */                                                                              \
+T                                                                                \
+name##_deque_front(const name##_deque_t *d);                                     \
+                                                                                 \
+/**                                                                              \
+ * name_deque_back returns the last item, or 0 if the deque is empty.            \
+ */                                                                              \
+T                                                                                \
+name##_deque_back(const name##_deque_t *d);                                      \
+                                                                                 \
+/**                                                                              \
+ * name_deque_get returns the item at the given index counting from the          \
+ * front, or 0 if the index is out of range.                                     \
+ */                                                                              \
+T                                                                                \
+name##_deque_get(const name##_deque_t *d, const uint64_t idx);                   \
+                                                                                 \
+/**                                                                              \
+ * name_deque_clear removes every item, keeping the buffer.                      \
+ */                                                                              \
+void                                                                             \
+name##_deque_clear(name##_deque_t *d);                                           \
+                                                                                 \
+/**                                                                              \
+ * name_deque_segments stores the items in first and second, in order. The       \
+ * second view is empty unless the items wrap around the end of the              \
+ * buffer. Both are invalidated by anything that grows the deque.                \
+ */                                                                              \
+void                                                                             \
+name##_deque_segments(const name##_deque_t *d, name##_view_t *first, name##_view_t *second); \
+                                                                                 \
+/**                                                                              \
+ * name_deque_foreach runs the user provided function on each item, from         \
+ * the front.                                                                    \
+ */                                                                              \
+int                                                                              \
+name##_deque_foreach(const name##_deque_t *d, name##_foreach_func_t ift, void *user_data);
+
+/**
+ * SLICE_DEFINE_DEQUE defines the deque declared by SLICE_DECLARE_DEQUE.
+ * The items are the len entries starting at head, wrapping around at cap,
+ * and cap being a power of 2 the wrap is a mask.
+ */
+#define SLICE_DEFINE_DEQUE(name, T)                                              \
+struct name##_deque {                                                            \
+    T *items;                                                                    \
+    uint64_t head;                                                               \
+    uint64_t len;                                                                \
+    uint64_t cap;                                                                \
+    const slice_allocator_t *allocator;                                          \
+};                                                                               \
+                                                                                 \
+/**                                                                              \
+ * name_deque_slot returns the position in the buffer of the item at the         \
+ * given index.                                                                  \
+ */                                                                              \
+static inline uint64_t                                                           \
+name##_deque_slot(const name##_deque_t *d, const uint64_t idx)                   \
+{                                                                                \
+	return (d->head + idx) & (d->cap - 1);                                   \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_deque_resize moves the items to a buffer of cap slots, a power of 2      \
+ * at least as large as the current one. After a realloc the items that          \
+ * had wrapped around are moved past the old end, which the doubled              \
+ * buffer always has room for.                                                   \
+ */                                                                              \
+static int                                                                       \
+name##_deque_resize(name##_deque_t *d, const uint64_t cap)                       \
+{                                                                                \
+	const uint64_t old = d->cap;                                             \
+	T *items;                                                                \
+                                                                                 \
+	if (d->items == NULL) {                                                  \
+		items = slice_alloc(d->allocator, sizeof(T) * cap);              \
+	} else {                                                                 \
+		items = slice_realloc(d->allocator, d->items, sizeof(T) * old, sizeof(T) * cap); \
+	}                                                                        \
+	if (items == NULL) {                                                     \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	if (d->head + d->len > old) {                                            \
+		memcpy(items + old, items, sizeof(T) * (d->head + d->len - old)); \
+	}                                                                        \
+	d->items = items;                                                        \
+	d->cap = cap;                                                            \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_deque_make_room makes sure n more items fit, growing to the next         \
+ * power of 2 that holds them.                                                   \
+ */                                                                              \
+static int                                                                       \
+name##_deque_make_room(name##_deque_t *d, const uint64_t n)                      \
+{                                                                                \
+	uint64_t cap = d->cap == 0 ? 8 : d->cap;                                 \
+                                                                                 \
+	if (d->len + n <= d->cap) {                                              \
+		return 0;                                                        \
+	}                                                                        \
+	while (cap < d->len + n) {                                               \
+		cap *= 2;                                                        \
+	}                                                                        \
+                                                                                 \
+	return name##_deque_resize(d, cap);                                      \
+}                                                                                \
+                                                                                 \
+name##_deque_t*                                                                  \
+name##_deque_new(const uint64_t cap)                                             \
+{                                                                                \
+	return name##_deque_new_with_allocator(cap, NULL);                       \
+}                                                                                \
+                                                                                 \
+name##_deque_t*                                                                  \
+name##_deque_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator) \
+{                                                                                \
+	name##_deque_t *d = slice_alloc(allocator, sizeof(name##_deque_t));      \
+	if (d == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+	d->items = NULL;                                                         \
+	d->head = 0;                                                             \
+	d->len = 0;                                                              \
+	d->cap = 0;                                                              \
+	d->allocator = allocator;                                                \
+                                                                                 \
+	if (cap != 0 && name##_deque_make_room(d, cap) != 0) {                   \
+		slice_free(allocator, d);                                        \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	return d;                                                                \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_deque_free(name##_deque_t *d)                                             \
+{                                                                                \
+	if (d == NULL) {                                                         \
+		return;                                                          \
+	}                                                                        \
+                                                                                 \
+	if (d->items != NULL) {                                                  \
+		slice_free(d->allocator, d->items);                              \
+	}                                                                        \
+	slice_free(d->allocator, d);                                             \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_deque_len(const name##_deque_t *d)                                        \
+{                                                                                \
+	return d->len;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_deque_cap(const name##_deque_t *d)                                        \
+{                                                                                \
+	return d->cap;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_deque_reserve(name##_deque_t *d, const uint64_t n)                        \
+{                                                                                \
+	if (n > d->len) {                                                        \
+		name##_deque_make_room(d, n - d->len);                           \
+	}                                                                        \
+                                                                                 \
+	return d->cap;                                                           \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_deque_push_back(name##_deque_t *d, const T val)                           \
+{                                                                                \
+	if (d->len == d->cap && name##_deque_make_room(d, 1) != 0) {             \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	d->items[name##_deque_slot(d, d->len)] = val;                            \
+	d->len++;                                                                \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_deque_push_front(name##_deque_t *d, const T val)                          \
+{                                                                                \
+	if (d->len == d->cap && name##_deque_make_room(d, 1) != 0) {             \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	d->head = (d->head - 1) & (d->cap - 1);                                  \
+	d->items[d->head] = val;                                                 \
+	d->len++;                                                                \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_deque_pop_front(name##_deque_t *d, T *val)                                \
+{                                                                                \
+	if (d->len == 0) {                                                       \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	if (val != NULL) {                                                       \
+		*val = d->items[d->head];                                        \
+	}                                                                        \
+	d->head = (d->head + 1) & (d->cap - 1);                                  \
+	d->len--;                                                                \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_deque_pop_back(name##_deque_t *d, T *val)                                 \
+{                                                                                \
+	if (d->len == 0) {                                                       \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	d->len--;                                                                \
+	if (val != NULL) {                                                       \
+		*val = d->items[name##_deque_slot(d, d->len)];                   \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_deque_push_back_n(name##_deque_t *d, const T *buf, const uint64_t n)      \
+{                                                                                \
+	if (n == 0) {                                                            \
+		return 0;                                                        \
+	}                                                                        \
+	if (name##_deque_make_room(d, n) != 0) {                                 \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	const uint64_t tail = name##_deque_slot(d, d->len);                      \
+	const uint64_t first = d->cap - tail < n ? d->cap - tail : n;            \
+                                                                                 \
+	memcpy(d->items + tail, buf, sizeof(T) * first);                         \
+	memcpy(d->items, buf + first, sizeof(T) * (n - first));                  \
+	d->len += n;                                                             \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_deque_pop_front_n(name##_deque_t *d, T *buf, const uint64_t n)            \
+{                                                                                \
+	const uint64_t count = n < d->len ? n : d->len;                          \
+                                                                                 \
+	if (count == 0) {                                                        \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	const uint64_t first = d->cap - d->head < count ? d->cap - d->head : count; \
+                                                                                 \
+	memcpy(buf, d->items + d->head, sizeof(T) * first);                      \
+	memcpy(buf + first, d->items, sizeof(T) * (count - first));              \
+	d->head = name##_deque_slot(d, count);                                   \
+	d->len -= count;                                                         \
+                                                                                 \
+	return count;                                                            \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_deque_front(const name##_deque_t *d)                                      \
+{                                                                                \
+	return name##_deque_get(d, 0);                                           \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_deque_back(const name##_deque_t *d)                                       \
+{                                                                                \
+	return name##_deque_get(d, d->len - 1);                                  \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_deque_get(const name##_deque_t *d, const uint64_t idx)                    \
+{                                                                                \
+	if (SLICE_IN_BOUNDS(idx, d->len)) {                                      \
+		return d->items[name##_deque_slot(d, idx)];                      \
+	}                                                                        \
+                                                                                 \
+	return (T){0};                                                           \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_deque_clear(name##_deque_t *d)                                            \
+{                                                                                \
+	d->head = 0;                                                             \
+	d->len = 0;                                                              \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_deque_segments(const name##_deque_t *d, name##_view_t *first, name##_view_t *second) \
+{                                                                                \
+	const uint64_t n = d->cap - d->head < d->len ? d->cap - d->head : d->len; \
+                                                                                 \
+	if (d->items == NULL) {                                                  \
+		first->items = second->items = NULL;                             \
+		first->len = second->len = 0;                                    \
+		return;                                                          \
+	}                                                                        \
+	first->items = d->items + d->head;                                       \
+	first->len = n;                                                          \
+	second->items = d->items;                                                \
+	second->len = d->len - n;                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_deque_foreach(const name##_deque_t *d, name##_foreach_func_t ift, void *user_data) \
+{                                                                                \
+	name##_view_t first;                                                     \
+	name##_view_t second;                                                    \
+                                                                                 \
+	name##_deque_segments(d, &first, &second);                               \
+	for (uint64_t i = 0; i < first.len; i++) {                               \
+		ift(first.items[i], user_data);                                  \
+	}                                                                        \
+	for (uint64_t i = 0; i < second.len; i++) {                              \
+		ift(second.items[i], user_data);                                 \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}
+
+/**
+ * SLICE_DECLARE_CONCURRENT declares name_concurrent_t, a slice that any
+ * number of threads can append to at the same time without a lock. Each
+ * append reserves its slots with a single atomic add on the length and
+ * writes them in place. The items live in segments that double in size,
+ * which are never reallocated, so items never move once written. Once the
+ * appends are over, name_concurrent_freeze copies the items into an
+ * ordinary contiguous slice. It has to follow the declaration of the
+ * slice.
+ *
+ * Only the appends are safe to run concurrently. Reading an item with
+ * name_concurrent_get, or freezing, must happen after the thread that
+ * appended it is known to be done, e.g. after joining it. The allocator
+ * must be safe to call from several threads.
+ */
+#define SLICE_DECLARE_CONCURRENT(name, T)                                        \
+typedef struct name##_concurrent name##_concurrent_t;                            \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_new creates an empty concurrent slice whose first             \
+ * segment holds at least cap items. Returns NULL if the allocation fails.       \
+ */                                                                              \
+name##_concurrent_t*                                                             \
+name##_concurrent_new(const uint64_t cap);                                       \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_new_with_allocator is name_concurrent_new taking all of       \
+ * its memory from the given allocator.                                          \
+ */                                                                              \
+name##_concurrent_t*                                                             \
+name##_concurrent_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator); \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_free frees the concurrent slice and its segments.             \
+ */                                                                              \
+void                                                                             \
+name##_concurrent_free(name##_concurrent_t *c);                                  \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_append appends val. It's safe to call from any number         \
+ * of threads at once. Returns -1 if the segment the item falls in couldn't      \
+ * be allocated, in which case its slot reads as 0.                              \
+ */                                                                              \
+int                                                                              \
+name##_concurrent_append(name##_concurrent_t *c, const T val);                   \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_append_n appends the n items of buf as one contiguous         \
+ * run, reserving their slots with a single atomic add, so producers that        \
+ * batch their items contend far less. It's safe to call concurrently with       \
+ * the other appends. Returns -1 if a segment couldn't be allocated.             \
+ */                                                                              \
+int                                                                              \
+name##_concurrent_append_n(name##_concurrent_t *c, const T *buf, const uint64_t n); \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_len returns the number of slots reserved so far, which        \
+ * includes those of appends still in progress.                                  \
+ */                                                                              \
+uint64_t                                                                         \
+name##_concurrent_len(const name##_concurrent_t *c);                             \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_get returns the item at the given index, or 0 if the          \
+ * index is out of range.                                                        \
+ */                                                                              \
+T                                                                                \
+name##_concurrent_get(const name##_concurrent_t *c, const uint64_t idx);         \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_freeze copies the items into a new slice, in the order        \
+ * of their slots, with a memcpy per segment. The concurrent slice is left       \
+ * as it was. Returns NULL if the slice can't be allocated.                      \
+ */                                                                              \
+name##_t*                                                                        \
+name##_concurrent_freeze(const name##_concurrent_t *c);
+
+/**
+ * SLICE_DEFINE_CONCURRENT defines the concurrent slice declared by
+ * SLICE_DECLARE_CONCURRENT. Segment k holds 1 << (shift + k) items, so
+ * adding 1 << shift to an index gives a number whose top bit picks the
+ * segment and whose other bits are the offset in it. The length is kept on
+ * a cache line of its own so the atomic adds of the producers don't keep
+ * taking the segment directory away from the other cores.
+ */
+#define SLICE_DEFINE_CONCURRENT(name, T)                                         \
+struct name##_concurrent {                                                       \
+    _Atomic uint64_t len;                                                        \
+    char pad[64 - sizeof(uint64_t)];                                             \
+    _Atomic(T*) segments[SLICE_CONCURRENT_SEGMENTS];                             \
+    unsigned int shift;                                                          \
+    const slice_allocator_t *allocator;                                          \
+};                                                                               \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_locate returns the segment holding the item at the            \
+ * given index and stores the item's offset in it in off.                        \
+ */                                                                              \
+static inline unsigned int                                                       \
+name##_concurrent_locate(const name##_concurrent_t *c, const uint64_t idx, uint64_t *off) \
+{                                                                                \
+	const uint64_t i = idx + ((uint64_t)1 << c->shift);                      \
+	const unsigned int top = 63 - (unsigned int)__builtin_clzll(i);          \
+                                                                                 \
+	*off = i - ((uint64_t)1 << top);                                         \
+                                                                                 \
+	return top - c->shift;                                                   \
+}                                                                                \
+                                                                                 \
+/**                                                                              \
+ * name_concurrent_segment returns segment k, allocating it if no thread         \
+ * has yet. Threads racing to allocate the same segment all try to install       \
+ * theirs with a compare and swap, the losers free theirs and use the            \
+ * winner's. A new segment is zeroed before it's installed, so the slot of       \
+ * an append that failed reads as 0 even once a later append allocates its       \
+ * segment. Returns NULL if the allocation fails.                                \
+ */                                                                              \
+static T*                                                                        \
+name##_concurrent_segment(name##_concurrent_t *c, const unsigned int k)          \
+{                                                                                \
+	const size_t size = sizeof(T) << (c->shift + k);                         \
+	T *seg = atomic_load_explicit(&c->segments[k], memory_order_acquire);    \
+	T *fresh;                                                                \
+                                                                                 \
+	if (seg != NULL) {                                                       \
+		return seg;                                                      \
+	}                                                                        \
+                                                                                 \
+	fresh = slice_alloc(c->allocator, size);                                 \
+	if (fresh == NULL) {                                                     \
+		return NULL;                                                     \
+	}                                                                        \
+	memset(fresh, 0, size);                                                  \
+	if (!atomic_compare_exchange_strong_explicit(&c->segments[k], &seg, fresh, memory_order_acq_rel, memory_order_acquire)) { \
+		slice_free(c->allocator, fresh);                                 \
+		return seg;                                                      \
+	}                                                                        \
+                                                                                 \
+	return fresh;                                                            \
+}                                                                                \
+                                                                                 \
+name##_concurrent_t*                                                             \
+name##_concurrent_new(const uint64_t cap)                                        \
+{                                                                                \
+	return name##_concurrent_new_with_allocator(cap, NULL);                  \
+}                                                                                \
+                                                                                 \
+name##_concurrent_t*                                                             \
+name##_concurrent_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator) \
+{                                                                                \
+	name##_concurrent_t *c = slice_alloc(allocator, sizeof(name##_concurrent_t)); \
+	if (c == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	c->shift = SLICE_CONCURRENT_MIN_SHIFT;                                   \
+	while (c->shift < 48 && ((uint64_t)1 << c->shift) < cap) {               \
+		c->shift++;                                                      \
+	}                                                                        \
+	c->allocator = allocator;                                                \
+	atomic_init(&c->len, 0);                                                 \
+	for (unsigned int k = 0; k < SLICE_CONCURRENT_SEGMENTS; k++) {           \
+		atomic_init(&c->segments[k], NULL);                              \
+	}                                                                        \
+                                                                                 \
+	if (cap != 0 && name##_concurrent_segment(c, 0) == NULL) {               \
+		slice_free(allocator, c);                                        \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	return c;                                                                \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_concurrent_free(name##_concurrent_t *c)                                   \
+{                                                                                \
+	if (c == NULL) {                                                         \
+		return;                                                          \
+	}                                                                        \
+                                                                                 \
+	for (unsigned int k = 0; k < SLICE_CONCURRENT_SEGMENTS; k++) {           \
+		T *seg = atomic_load_explicit(&c->segments[k], memory_order_relaxed); \
+		if (seg != NULL) {                                               \
+			slice_free(c->allocator, seg);                           \
+		}                                                                \
+	}                                                                        \
+	slice_free(c->allocator, c);                                             \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_concurrent_append(name##_concurrent_t *c, const T val)                    \
+{                                                                                \
+	const uint64_t idx = atomic_fetch_add_explicit(&c->len, 1, memory_order_relaxed); \
+	uint64_t off;                                                            \
+	T *seg = name##_concurrent_segment(c, name##_concurrent_locate(c, idx, &off)); \
+                                                                                 \
+	if (seg == NULL) {                                                       \
+		return -1;                                                       \
+	}                                                                        \
+	seg[off] = val;                                                          \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_concurrent_append_n(name##_concurrent_t *c, const T *buf, const uint64_t n) \
+{                                                                                \
+	uint64_t idx;                                                            \
+	uint64_t done = 0;                                                       \
+	int ret = 0;                                                             \
+                                                                                 \
+	if (n == 0) {                                                            \
+		return 0;                                                        \
+	}                                                                        \
+                                                                                 \
+	/**                                                                      \
+	 * the run may span segments, each gets the part that falls in it.       \
+	 */                                                                      \
+	idx = atomic_fetch_add_explicit(&c->len, n, memory_order_relaxed);       \
+	while (done < n) {                                                       \
+		uint64_t off;                                                    \
+		const unsigned int k = name##_concurrent_locate(c, idx + done, &off); \
+		const uint64_t room = ((uint64_t)1 << (c->shift + k)) - off;     \
+		const uint64_t part = n - done < room ? n - done : room;         \
+		T *seg = name##_concurrent_segment(c, k);                        \
+                                                                                 \
+		if (seg != NULL) {                                               \
+			memcpy(seg + off, buf + done, sizeof(T) * part);         \
+		} else {                                                         \
+			ret = -1;                                                \
+		}                                                                \
+		done += part;                                                    \
+	}                                                                        \
+                                                                                 \
+	return ret;                                                              \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_concurrent_len(const name##_concurrent_t *c)                              \
+{                                                                                \
+	return atomic_load_explicit(&c->len, memory_order_relaxed);              \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_concurrent_get(const name##_concurrent_t *c, const uint64_t idx)          \
+{                                                                                \
+	uint64_t off;                                                            \
+	const T *seg;                                                            \
+                                                                                 \
+	if (idx >= name##_concurrent_len(c)) {                                   \
+		return (T){0};                                                   \
+	}                                                                        \
+                                                                                 \
+	seg = atomic_load_explicit(&c->segments[name##_concurrent_locate(c, idx, &off)], memory_order_acquire); \
+	if (seg == NULL) {                                                       \
+		return (T){0};                                                   \
+	}                                                                        \
+                                                                                 \
+	return seg[off];                                                         \
+}                                                                                \
+                                                                                 \
+name##_t*                                                                        \
+name##_concurrent_freeze(const name##_concurrent_t *c)                           \
+{                                                                                \
+	const uint64_t len = name##_concurrent_len(c);                           \
+	name##_t *s = name##_new_with_allocator(len, c->allocator);              \
+                                                                                 \
+	if (s == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	for (unsigned int k = 0; name##_len(s) < len; k++) {                     \
+		const uint64_t size = (uint64_t)1 << (c->shift + k);             \
+		const uint64_t part = len - name##_len(s) < size ? len - name##_len(s) : size; \
+		const T *seg = atomic_load_explicit(&c->segments[k], memory_order_acquire); \
+                                                                                 \
+		if (seg != NULL) {                                               \
+			name##_append_n(s, seg, part);                           \
+		} else {                                                         \
+			name##_repeat(s, (T){0}, part);                          \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return s;                                                                \
+}
+
+/**
+ * SLICE_DECLARE_CHUNKED declares name_chunked_t, a slice whose items live
+ * in fixed size chunks of a power of 2 items each, found through a small
+ * directory of chunk pointers. Growing adds a chunk and never copies the
+ * items, so appends take the same time however large the slice is, and
+ * the address of an item stays valid for as long as the item is in the
+ * slice. get splits the index with a shift and a mask. It has to follow
+ * the declaration of the slice.
+ */
+#define SLICE_DECLARE_CHUNKED(name, T)                                           \
+typedef struct name##_chunked name##_chunked_t;                                  \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_new creates an empty chunked slice with room for at least        \
+ * cap items. Returns NULL if the allocation fails.                              \
+ */                                                                              \
+name##_chunked_t*                                                                \
+name##_chunked_new(const uint64_t cap);                                          \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_new_with_allocator is name_chunked_new taking all of its         \
+ * memory from the given allocator.                                              \
+ */                                                                              \
+name##_chunked_t*                                                                \
+name##_chunked_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator); \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_free frees the chunked slice and its chunks.                     \
+ */                                                                              \
+void                                                                             \
+name##_chunked_free(name##_chunked_t *c);                                        \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_len returns the number of items in the chunked slice.            \
+ */                                                                              \
+uint64_t                                                                         \
+name##_chunked_len(const name##_chunked_t *c);                                   \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_cap returns the number of items that fit in the chunks           \
+ * allocated so far.                                                             \
+ */                                                                              \
+uint64_t                                                                         \
+name##_chunked_cap(const name##_chunked_t *c);                                   \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_chunk_len returns the number of items per chunk.                 \
+ */                                                                              \
+uint64_t                                                                         \
+name##_chunked_chunk_len(const name##_chunked_t *c);                             \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_reserve allocates the chunks needed to hold n items and          \
+ * returns the capacity.                                                         \
+ */                                                                              \
+uint64_t                                                                         \
+name##_chunked_reserve(name##_chunked_t *c, const uint64_t n);                   \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_append appends val. Returns -1 if a chunk couldn't be            \
+ * allocated.                                                                    \
+ */                                                                              \
+int                                                                              \
+name##_chunked_append(name##_chunked_t *c, const T val);                         \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_append_n appends the n items of buf with a memcpy per chunk      \
+ * they fall in. Returns -1, having appended none of them, if the chunks         \
+ * couldn't be allocated.                                                        \
+ */                                                                              \
+int                                                                              \
+name##_chunked_append_n(name##_chunked_t *c, const T *buf, const uint64_t n);    \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_pop_back removes the last item and stores it in val, which       \
+ * may be NULL. Its chunk is kept for the next appends. Returns -1 if the        \
+ * slice is empty.                                                               \
+ */                                                                              \
+int                                                                              \
+name##_chunked_pop_back(name##_chunked_t *c, T *val);                            \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_get returns the item at the given index, or 0 if the index       \
+ * is out of range.                                                              \
+ */                                                                              \
+T                                                                                \
+name##_chunked_get(const name##_chunked_t *c, const uint64_t idx);               \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_at returns the address of the item at the given index, or        \
+ * NULL if the index is out of range. It stays valid until the item is           \
+ * popped or the slice freed.                                                    \
+ */                                                                              \
+T*                                                                               \
+name##_chunked_at(const name##_chunked_t *c, const uint64_t idx);                \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_set replaces the item at the given index. Returns -1 if the      \
+ * index is out of range.                                                        \
+ */                                                                              \
+int                                                                              \
+name##_chunked_set(name##_chunked_t *c, const uint64_t idx, const T val);        \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_clear removes every item, keeping the chunks.                    \
+ */                                                                              \
+void                                                                             \
+name##_chunked_clear(name##_chunked_t *c);                                       \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_foreach runs the user provided function on each item.            \
+ */                                                                              \
+int                                                                              \
+name##_chunked_foreach(const name##_chunked_t *c, name##_foreach_func_t ift, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_foreach_block runs the user provided function once per           \
+ * chunk, passing the items of the chunk as a pointer and a count.               \
+ */                                                                              \
+int                                                                              \
+name##_chunked_foreach_block(const name##_chunked_t *c, name##_block_func_t fn, void *user_data); \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_to_slice copies the items into a new contiguous slice with       \
+ * a memcpy per chunk. Returns NULL if the slice can't be allocated.             \
+ */                                                                              \
+name##_t*                                                                        \
+name##_chunked_to_slice(const name##_chunked_t *c);
+
+/**
+ * SLICE_DEFINE_CHUNKED defines the chunked slice declared by
+ * SLICE_DECLARE_CHUNKED. Item i is at offset i & mask of chunk i >> shift.
+ * Only the directory is ever reallocated, and it holds a pointer per
+ * chunk.
+ */
+#define SLICE_DEFINE_CHUNKED(name, T)                                            \
+struct name##_chunked {                                                          \
+    T **chunks;                                                                  \
+    uint64_t nchunks;                                                            \
+    uint64_t dir_cap;                                                            \
+    uint64_t len;                                                                \
+    unsigned int shift;                                                          \
+    uint64_t mask;                                                               \
+    const slice_allocator_t *allocator;                                          \
+};                                                                               \
+                                                                                 \
+/**                                                                              \
+ * name_chunked_add_chunk allocates one more chunk, doubling the directory       \
+ * first if it's full.                                                           \
+ */                                                                              \
+static int                                                                       \
+name##_chunked_add_chunk(name##_chunked_t *c)                                    \
+{                                                                                \
+	T *chunk;                                                                \
+                                                                                 \
+	if (c->nchunks == c->dir_cap) {                                          \
+		uint64_t cap = c->dir_cap == 0 ? 8 : c->dir_cap * 2;             \
+		T **chunks;                                                      \
+                                                                                 \
+		if (c->chunks == NULL) {                                         \
+			chunks = slice_alloc(c->allocator, sizeof(T*) * cap);    \
+		} else {                                                         \
+			chunks = slice_realloc(c->allocator, c->chunks, sizeof(T*) * c->dir_cap, sizeof(T*) * cap); \
+		}                                                                \
+		if (chunks == NULL) {                                            \
+			return -1;                                               \
+		}                                                                \
+		c->chunks = chunks;                                              \
+		c->dir_cap = cap;                                                \
+	}                                                                        \
+                                                                                 \
+	chunk = slice_alloc(c->allocator, sizeof(T) << c->shift);                \
+	if (chunk == NULL) {                                                     \
+		return -1;                                                       \
+	}                                                                        \
+	c->chunks[c->nchunks++] = chunk;                                         \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+name##_chunked_t*                                                                \
+name##_chunked_new(const uint64_t cap)                                           \
+{                                                                                \
+	return name##_chunked_new_with_allocator(cap, NULL);                     \
+}                                                                                \
+                                                                                 \
+name##_chunked_t*                                                                \
+name##_chunked_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator) \
+{                                                                                \
+	name##_chunked_t *c = slice_alloc(allocator, sizeof(name##_chunked_t));  \
+	if (c == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+	c->chunks = NULL;                                                        \
+	c->nchunks = 0;                                                          \
+	c->dir_cap = 0;                                                          \
+	c->len = 0;                                                              \
+	c->shift = 0;                                                            \
+	while (((uint64_t)2 << c->shift) * sizeof(T) <= SLICE_CHUNK_BYTES) {     \
+		c->shift++;                                                      \
+	}                                                                        \
+	c->mask = ((uint64_t)1 << c->shift) - 1;                                 \
+	c->allocator = allocator;                                                \
+                                                                                 \
+	if (name##_chunked_reserve(c, cap) < cap) {                              \
+		name##_chunked_free(c);                                          \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	return c;                                                                \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_chunked_free(name##_chunked_t *c)                                         \
+{                                                                                \
+	if (c == NULL) {                                                         \
+		return;                                                          \
+	}                                                                        \
+                                                                                 \
+	for (uint64_t i = 0; i < c->nchunks; i++) {                              \
+		slice_free(c->allocator, c->chunks[i]);                          \
+	}                                                                        \
+	if (c->chunks != NULL) {                                                 \
+		slice_free(c->allocator, c->chunks);                             \
+	}                                                                        \
+	slice_free(c->allocator, c);                                             \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_chunked_len(const name##_chunked_t *c)                                    \
+{                                                                                \
+	return c->len;                                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_chunked_cap(const name##_chunked_t *c)                                    \
+{                                                                                \
+	return c->nchunks << c->shift;                                           \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_chunked_chunk_len(const name##_chunked_t *c)                              \
+{                                                                                \
+	return c->mask + 1;                                                      \
+}                                                                                \
+                                                                                 \
+uint64_t                                                                         \
+name##_chunked_reserve(name##_chunked_t *c, const uint64_t n)                    \
+{                                                                                \
+	while (name##_chunked_cap(c) < n && name##_chunked_add_chunk(c) == 0) {  \
+	}                                                                        \
+                                                                                 \
+	return name##_chunked_cap(c);                                            \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_chunked_append(name##_chunked_t *c, const T val)                          \
+{                                                                                \
+	if (c->len == name##_chunked_cap(c) && name##_chunked_add_chunk(c) != 0) { \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	c->chunks[c->len >> c->shift][c->len & c->mask] = val;                   \
+	c->len++;                                                                \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_chunked_append_n(name##_chunked_t *c, const T *buf, const uint64_t n)     \
+{                                                                                \
+	uint64_t done = 0;                                                       \
+                                                                                 \
+	if (name##_chunked_reserve(c, c->len + n) < c->len + n) {                \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	while (done < n) {                                                       \
+		const uint64_t off = c->len & c->mask;                           \
+		const uint64_t room = c->mask + 1 - off;                         \
+		const uint64_t part = n - done < room ? n - done : room;         \
+                                                                                 \
+		memcpy(c->chunks[c->len >> c->shift] + off, buf + done, sizeof(T) * part); \
+		c->len += part;                                                  \
+		done += part;                                                    \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_chunked_pop_back(name##_chunked_t *c, T *val)                             \
+{                                                                                \
+	if (c->len == 0) {                                                       \
+		return -1;                                                       \
+	}                                                                        \
+                                                                                 \
+	c->len--;                                                                \
+	if (val != NULL) {                                                       \
+		*val = c->chunks[c->len >> c->shift][c->len & c->mask];          \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+T                                                                                \
+name##_chunked_get(const name##_chunked_t *c, const uint64_t idx)                \
+{                                                                                \
+	if (SLICE_IN_BOUNDS(idx, c->len)) {                                      \
+		return c->chunks[idx >> c->shift][idx & c->mask];                \
+	}                                                                        \
+                                                                                 \
+	return (T){0};                                                           \
+}                                                                                \
+                                                                                 \
+T*                                                                               \
+name##_chunked_at(const name##_chunked_t *c, const uint64_t idx)                 \
+{                                                                                \
+	if (idx >= c->len) {                                                     \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	return &c->chunks[idx >> c->shift][idx & c->mask];                       \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_chunked_set(name##_chunked_t *c, const uint64_t idx, const T val)         \
+{                                                                                \
+	if (idx >= c->len) {                                                     \
+		return -1;                                                       \
+	}                                                                        \
+	c->chunks[idx >> c->shift][idx & c->mask] = val;                         \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+void                                                                             \
+name##_chunked_clear(name##_chunked_t *c)                                        \
+{                                                                                \
+	c->len = 0;                                                              \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_chunked_foreach(const name##_chunked_t *c, name##_foreach_func_t ift, void *user_data) \
+{                                                                                \
+	for (uint64_t base = 0; base < c->len; base += c->mask + 1) {            \
+		const T *chunk = c->chunks[base >> c->shift];                    \
+		const uint64_t n = c->len - base < c->mask + 1 ? c->len - base : c->mask + 1; \
+                                                                                 \
+		for (uint64_t i = 0; i < n; i++) {                               \
+			ift(chunk[i], user_data);                                \
+		}                                                                \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+int                                                                              \
+name##_chunked_foreach_block(const name##_chunked_t *c, name##_block_func_t fn, void *user_data) \
+{                                                                                \
+	for (uint64_t base = 0; base < c->len; base += c->mask + 1) {            \
+		const uint64_t n = c->len - base < c->mask + 1 ? c->len - base : c->mask + 1; \
+                                                                                 \
+		fn(c->chunks[base >> c->shift], n, user_data);                   \
+	}                                                                        \
+                                                                                 \
+	return 0;                                                                \
+}                                                                                \
+                                                                                 \
+name##_t*                                                                        \
+name##_chunked_to_slice(const name##_chunked_t *c)                               \
+{                                                                                \
+	name##_t *s = name##_new_with_allocator(c->len, c->allocator);           \
+                                                                                 \
+	if (s == NULL) {                                                         \
+		return NULL;                                                     \
+	}                                                                        \
+                                                                                 \
+	for (uint64_t base = 0; base < c->len; base += c->mask + 1) {            \
+		const uint64_t n = c->len - base < c->mask + 1 ? c->len - base : c->mask + 1; \
+                                                                                 \
+		name##_append_n(s, c->chunks[base >> c->shift], n);              \
+	}                                                                        \
+                                                                                 \
+	return s;                                                                \
+}
+
+#endif /** end __SLICE_H */
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,482 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "slice_allocator.h"
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+#define SLICE_ALIGN _Alignof(max_align_t)
+#define SLICE_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+/**
+ * slice_align_up rounds size up to the strictest fundamental alignment so
+ * every allocation handed out is suitably aligned for any element type.
+ */
+static size_t
+slice_align_up(size_t size)
+{
+	return (size + SLICE_ALIGN - 1) & ~(SLICE_ALIGN - 1);
+}
+
+struct slice_arena_block {
+	struct slice_arena_block *next;
+	size_t size;
+	size_t used;
+	max_align_t data[];
+};
+
+struct slice_arena {
+	slice_allocator_t allocator;
+	struct slice_arena_block *head;
+	struct slice_arena_block *last_block;
+	void *last;
+	size_t block_size;
+	size_t used;
+};
+
+static struct slice_arena_block*
+slice_arena_block_new(size_t size)
+{
+	struct slice_arena_block *b = malloc(sizeof(struct slice_arena_block) + size);
+	if (b == NULL) {
+		return NULL;
+	}
+	b->next = NULL;
+	b->size = size;
+	b->used = 0;
+
+	return b;
+}
+
+static void*
+slice_arena_alloc(void *ctx, size_t size)
+{
+	slice_arena_t *a = ctx;
+	struct slice_arena_block *b = a->head;
+
+	size = slice_align_up(size);
+
+	if (b == NULL || b->size - b->used < size) {
+		if (size > a->block_size && b != NULL) {
+			/**
+			 * oversized requests get a block of their own placed behind the
+			 * current one so its remaining space keeps being used.
+			 */
+			b = slice_arena_block_new(size);
+			if (b == NULL) {
+				return NULL;
+			}
+			b->next = a->head->next;
+			a->head->next = b;
+		} else {
+			b = slice_arena_block_new(size > a->block_size ? size : a->block_size);
+			if (b == NULL) {
+				return NULL;
+			}
+			b->next = a->head;
+			a->head = b;
+		}
+	}
+
+	void *ptr = (unsigned char*)b->data + b->used;
+	b->used += size;
+	a->used += size;
+	a->last_block = b;
+	a->last = ptr;
+
+	return ptr;
+}
+
+static void*
+slice_arena_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+	slice_arena_t *a = ctx;
+
+	if (ptr == NULL) {
+		return slice_arena_alloc(ctx, new_size);
+	}
+
+	old_size = slice_align_up(old_size);
+	new_size = slice_align_up(new_size);
+
+	if (new_size <= old_size) {
+		return ptr;
+	}
+
+	/**
+	 * the most recent allocation can be extended in place when its block
+	 * has room, which is the common case for a slice growing on its own.
+	 */
+	if (ptr == a->last) {
+		struct slice_arena_block *b = a->last_block;
+		if (b->size - b->used >= new_size - old_size) {
+			b->used += new_size - old_size;
+			a->used += new_size - old_size;
+			return ptr;
+		}
+	}
+
+	void *n = slice_arena_alloc(ctx, new_size);
+	if (n == NULL) {
+		return NULL;
+	}
+	memcpy(n, ptr, old_size);
+
+	return n;
+}
+
+static void
+slice_arena_release(void *ctx, void *ptr)
+{
+	(void)ctx;
+	(void)ptr;
+}
+
+slice_arena_t*
+slice_arena_new(size_t block_size)
+{
+	slice_arena_t *a = calloc(1, sizeof(slice_arena_t));
+	if (a == NULL) {
+		return NULL;
+	}
+
+	a->block_size = slice_align_up(block_size == 0 ? SLICE_ARENA_DEFAULT_BLOCK_SIZE : block_size);
+	a->allocator.alloc = slice_arena_alloc;
+	a->allocator.realloc = slice_arena_realloc;
+	a->allocator.free = slice_arena_release;
+	a->allocator.ctx = a;
+
+	return a;
+}
+
+const slice_allocator_t*
+slice_arena_allocator(slice_arena_t *a)
+{
+	return &a->allocator;
+}
+
+size_t
+slice_arena_used(const slice_arena_t *a)
+{
+	return a->used;
+}
+
+void
+slice_arena_reset(slice_arena_t *a)
+{
+	struct slice_arena_block *keep = NULL;
+	struct slice_arena_block *b = a->head;
+
+	while (b != NULL) {
+		struct slice_arena_block *next = b->next;
+		if (keep == NULL && b->size == a->block_size) {
+			keep = b;
+		} else {
+			free(b);
+		}
+		b = next;
+	}
+
+	if (keep != NULL) {
+		keep->next = NULL;
+		keep->used = 0;
+	}
+	a->head = keep;
+	a->last_block = NULL;
+	a->last = NULL;
+	a->used = 0;
+}
+
+void
+slice_arena_free(slice_arena_t *a)
+{
+	if (a == NULL) {
+		return;
+	}
+
+	struct slice_arena_block *b = a->head;
+	while (b != NULL) {
+		struct slice_arena_block *next = b->next;
+		free(b);
+		b = next;
+	}
+	free(a);
+}
+
+struct slice_pool {
+	slice_allocator_t allocator;
+	unsigned char *slab;
+	void *free_list;
+	size_t block_size;
+	size_t count;
+	size_t available;
+};
+
+static bool
+slice_pool_owns(const slice_pool_t *p, const void *ptr)
+{
+	const unsigned char *c = ptr;
+	return c >= p->slab && c < p->slab + p->block_size * p->count;
+}
+
+static void*
+slice_pool_alloc(void *ctx, size_t size)
+{
+	slice_pool_t *p = ctx;
+
+	if (size > p->block_size || p->free_list == NULL) {
+		return malloc(size);
+	}
+
+	void *ptr = p->free_list;
+	p->free_list = *(void**)ptr;
+	p->available--;
+
+	return ptr;
+}
+
+static void
+slice_pool_release(void *ctx, void *ptr)
+{
+	slice_pool_t *p = ctx;
+
+	if (ptr == NULL) {
+		return;
+	}
+
+	if (!slice_pool_owns(p, ptr)) {
+		free(ptr);
+		return;
+	}
+
+	*(void**)ptr = p->free_list;
+	p->free_list = ptr;
+	p->available++;
+}
+
+static void*
+slice_pool_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+	slice_pool_t *p = ctx;
+
+	if (ptr == NULL) {
+		return slice_pool_alloc(ctx, new_size);
+	}
+
+	if (!slice_pool_owns(p, ptr)) {
+		return realloc(ptr, new_size);
+	}
+
+	if (new_size <= p->block_size) {
+		return ptr;
+	}
+
+	void *n = malloc(new_size);
+	if (n == NULL) {
+		return NULL;
+	}
+	memcpy(n, ptr, old_size < new_size ? old_size : new_size);
+	slice_pool_release(ctx, ptr);
+
+	return n;
+}
+
+slice_pool_t*
+slice_pool_new(size_t block_size, size_t count)
+{
+	slice_pool_t *p = calloc(1, sizeof(slice_pool_t));
+	if (p == NULL) {
+		return NULL;
+	}
+
+	if (block_size < sizeof(void*)) {
+		block_size = sizeof(void*);
+	}
+	p->block_size = slice_align_up(block_size);
+	p->count = count;
+	p->slab = malloc(p->block_size * count);
+	if (p->slab == NULL && count != 0) {
+		free(p);
+		return NULL;
+	}
+
+	p->allocator.alloc = slice_pool_alloc;
+	p->allocator.realloc = slice_pool_realloc;
+	p->allocator.free = slice_pool_release;
+	p->allocator.ctx = p;
+	slice_pool_reset(p);
+
+	return p;
+}
+
+const slice_allocator_t*
+slice_pool_allocator(slice_pool_t *p)
+{
+	return &p->allocator;
+}
+
+size_t
+slice_pool_available(const slice_pool_t *p)
+{
+	return p->available;
+}
+
+void
+slice_pool_reset(slice_pool_t *p)
+{
+	p->free_list = NULL;
+	for (size_t i = p->count; i > 0; i--) {
+		void *block = p->slab + (i - 1) * p->block_size;
+		*(void**)block = p->free_list;
+		p->free_list = block;
+	}
+	p->available = p->count;
+}
+
+void
+slice_pool_free(slice_pool_t *p)
+{
+	if (p == NULL) {
+		return;
+	}
+
+	free(p->slab);
+	free(p);
+}
+
+/**
+ * slice_mmap_header sits at the start of every mapping made by the mmap
+ * allocator and records its length, since munmap and mremap need it and
+ * free isn't told the size. It's padded to a cache line so the items that
+ * follow stay aligned.
+ */
+struct slice_mmap_header {
+	size_t size;
+	unsigned char pad[64 - sizeof(size_t)];
+};
+
+static size_t
+slice_mmap_round(size_t size)
+{
+	static size_t page_size = 0;
+
+	if (page_size == 0) {
+		long ps = sysconf(_SC_PAGESIZE);
+		page_size = ps > 0 ? (size_t)ps : 4096;
+	}
+
+	return (size + sizeof(struct slice_mmap_header) + page_size - 1) & ~(page_size - 1);
+}
+
+static void
+slice_mmap_advise(void *ctx, void *base, size_t size)
+{
+#if defined(MADV_HUGEPAGE)
+	if (ctx != NULL) {
+		madvise(base, size, MADV_HUGEPAGE);
+	}
+#else
+	(void)ctx;
+	(void)base;
+	(void)size;
+#endif
+}
+
+static void*
+slice_mmap_alloc(void *ctx, size_t size)
+{
+	size_t total = slice_mmap_round(size);
+
+	struct slice_mmap_header *h = mmap(NULL, total, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (h == MAP_FAILED) {
+		return NULL;
+	}
+	slice_mmap_advise(ctx, h, total);
+	h->size = total;
+
+	return h + 1;
+}
+
+static void
+slice_mmap_release(void *ctx, void *ptr)
+{
+	(void)ctx;
+
+	if (ptr == NULL) {
+		return;
+	}
+
+	struct slice_mmap_header *h = (struct slice_mmap_header*)ptr - 1;
+	munmap(h, h->size);
+}
+
+static void*
+slice_mmap_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+	if (ptr == NULL) {
+		return slice_mmap_alloc(ctx, new_size);
+	}
+
+	struct slice_mmap_header *h = (struct slice_mmap_header*)ptr - 1;
+	size_t total = slice_mmap_round(new_size);
+
+	if (total == h->size) {
+		return ptr;
+	}
+
+#if defined(__linux__)
+	(void)old_size;
+
+	struct slice_mmap_header *n = mremap(h, h->size, total, MREMAP_MAYMOVE);
+	if (n == MAP_FAILED) {
+		return NULL;
+	}
+	if (total > n->size) {
+		slice_mmap_advise(ctx, n, total);
+	}
+	n->size = total;
+
+	return n + 1;
+#else
+	void *n = slice_mmap_alloc(ctx, new_size);
+	if (n == NULL) {
+		return NULL;
+	}
+	memcpy(n, ptr, old_size < new_size ? old_size : new_size);
+	slice_mmap_release(ctx, ptr);
+
+	return n;
+#endif
+}
+
+const slice_allocator_t slice_mmap_allocator = {
+	slice_mmap_alloc,
+	slice_mmap_realloc,
+	slice_mmap_release,
+	NULL,
+};
+
+/**
+ * the hugepage variant only needs ctx to be non-NULL, point it at itself.
+ */
+const slice_allocator_t slice_mmap_hugepage_allocator = {
+	slice_mmap_alloc,
+	slice_mmap_realloc,
+	slice_mmap_release,
+	(void*)&slice_mmap_hugepage_allocator,
+};
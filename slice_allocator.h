@@ -0,0 +1,161 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SLICE_ALLOCATOR_H
+#define __SLICE_ALLOCATOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * slice_allocator_t is the set of functions a slice uses to get and release
+ * memory. ctx is handed back to every call so one implementation can serve
+ * many arenas or pools. realloc receives the size of the old block so
+ * allocators that don't track sizes themselves can copy the contents.
+ */
+typedef struct slice_allocator {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void  (*free)(void *ctx, void *ptr);
+    void *ctx;
+} slice_allocator_t;
+
+typedef struct slice_arena slice_arena_t;
+typedef struct slice_pool slice_pool_t;
+
+/**
+ * slice_alloc allocates size bytes from the given allocator. A NULL
+ * allocator means the C library's malloc.
+ */
+static inline void*
+slice_alloc(const slice_allocator_t *a, size_t size)
+{
+    if (a == NULL) {
+        return malloc(size);
+    }
+    return a->alloc(a->ctx, size);
+}
+
+/**
+ * slice_realloc resizes a block previously returned by the given allocator.
+ */
+static inline void*
+slice_realloc(const slice_allocator_t *a, void *ptr, size_t old_size, size_t new_size)
+{
+    if (a == NULL) {
+        return realloc(ptr, new_size);
+    }
+    return a->realloc(a->ctx, ptr, old_size, new_size);
+}
+
+/**
+ * slice_free releases a block previously returned by the given allocator.
+ */
+static inline void
+slice_free(const slice_allocator_t *a, void *ptr)
+{
+    if (a == NULL) {
+        free(ptr);
+        return;
+    }
+    a->free(a->ctx, ptr);
+}
+
+/**
+ * slice_mmap_allocator maps every allocation directly from the kernel and
+ * grows it with mremap, so resizing a very large slice remaps its pages
+ * instead of copying them and never holds both copies at once. Mappings
+ * are made with MAP_NORESERVE, only the pages actually touched count
+ * towards the process's memory. Meant for slices of many megabytes, small
+ * slices waste most of a page. Pair it with SLICE_GROWTH_PAGE or
+ * SLICE_GROWTH_HALF to keep the reserved address space close to the size
+ * in use.
+ */
+extern const slice_allocator_t slice_mmap_allocator;
+
+/**
+ * slice_mmap_hugepage_allocator is slice_mmap_allocator additionally asking
+ * the kernel to back the mappings with transparent huge pages.
+ */
+extern const slice_allocator_t slice_mmap_hugepage_allocator;
+
+/**
+ * slice_arena_new creates a bump allocator that hands out memory from blocks
+ * of block_size bytes. Freeing individual allocations is a no-op, the memory
+ * is given back all at once with slice_arena_reset or slice_arena_free. An
+ * arena is not safe to share between threads. A block_size of 0 selects
+ * the default of 64KB.
+ */
+slice_arena_t*
+slice_arena_new(size_t block_size);
+
+/**
+ * slice_arena_allocator returns the allocator to pass to the
+ * *_slice_new_with_allocator functions. It lives as long as the arena.
+ */
+const slice_allocator_t*
+slice_arena_allocator(slice_arena_t *a);
+
+/**
+ * slice_arena_used returns the number of bytes handed out since the arena
+ * was created or last reset.
+ */
+size_t
+slice_arena_used(const slice_arena_t *a);
+
+/**
+ * slice_arena_reset invalidates every allocation made from the arena and
+ * keeps its first block for reuse. Any slice allocated from the arena must
+ * not be used afterwards.
+ */
+void
+slice_arena_reset(slice_arena_t *a);
+
+/**
+ * slice_arena_free releases the arena and all memory allocated from it.
+ */
+void
+slice_arena_free(slice_arena_t *a);
+
+/**
+ * slice_pool_new creates a pool of count blocks of block_size bytes carved
+ * out of one allocation. Requests larger than block_size, or made while the
+ * pool is exhausted, fall back to malloc and are freed normally. A pool is
+ * not safe to share between threads.
+ */
+slice_pool_t*
+slice_pool_new(size_t block_size, size_t count);
+
+/**
+ * slice_pool_allocator returns the allocator to pass to the
+ * *_slice_new_with_allocator functions. It lives as long as the pool.
+ */
+const slice_allocator_t*
+slice_pool_allocator(slice_pool_t *p);
+
+/**
+ * slice_pool_available returns the number of unused blocks in the pool.
+ */
+size_t
+slice_pool_available(const slice_pool_t *p);
+
+/**
+ * slice_pool_reset returns every block to the pool. Allocations that fell
+ * back to malloc are not tracked and must have been freed already.
+ */
+void
+slice_pool_reset(slice_pool_t *p);
+
+/**
+ * slice_pool_free releases the pool and its blocks.
+ */
+void
+slice_pool_free(slice_pool_t *p);
+
+#endif /** end __SLICE_ALLOCATOR_H */
+#ifdef __cplusplus
+}
+#endif
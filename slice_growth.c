@@ -0,0 +1,45 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "slice_growth.h"
+
+#define SLICE_GROWTH_MIN_CAP 4
+#define SLICE_GROWTH_PAGE_SIZE 4096
+
+uint64_t
+slice_growth_next_cap(slice_growth_t growth, const uint64_t cap, const uint64_t needed, const size_t elem_size)
+{
+	uint64_t next;
+
+	switch (growth) {
+	case SLICE_GROWTH_HALF:
+		next = cap + cap / 2;
+		break;
+	case SLICE_GROWTH_PAGE: {
+		uint64_t bytes = needed * elem_size;
+		bytes = (bytes + SLICE_GROWTH_PAGE_SIZE - 1) & ~(uint64_t)(SLICE_GROWTH_PAGE_SIZE - 1);
+		next = bytes / elem_size;
+		break;
+	}
+	case SLICE_GROWTH_EXACT:
+		next = needed;
+		break;
+	case SLICE_GROWTH_DOUBLE:
+	default:
+		next = cap * 2;
+		break;
+	}
+
+	/**
+	 * next wraps or stalls for very large and zero capacities, in both
+	 * cases fall back to what was asked for.
+	 */
+	if (next < cap || next < needed) {
+		next = needed;
+	}
+	if (growth != SLICE_GROWTH_EXACT && next < SLICE_GROWTH_MIN_CAP) {
+		next = SLICE_GROWTH_MIN_CAP;
+	}
+
+	return next;
+}
@@ -0,0 +1,39 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SLICE_GROWTH_H
+#define __SLICE_GROWTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * slice_growth_t selects how a slice computes its new capacity when an
+ * append runs out of room.
+ *
+ * SLICE_GROWTH_DOUBLE  doubles the capacity, the default.
+ * SLICE_GROWTH_HALF    grows the capacity by half, trading more reallocs
+ *                      for at most a third of the memory left unused.
+ * SLICE_GROWTH_PAGE    rounds the buffer up to the next page boundary.
+ * SLICE_GROWTH_EXACT   grows to exactly the number of items needed.
+ */
+typedef enum {
+    SLICE_GROWTH_DOUBLE = 0,
+    SLICE_GROWTH_HALF,
+    SLICE_GROWTH_PAGE,
+    SLICE_GROWTH_EXACT,
+} slice_growth_t;
+
+/**
+ * slice_growth_next_cap returns the capacity, in items of elem_size bytes,
+ * that a slice currently holding cap items should grow to so it can hold
+ * at least needed items. A capacity of 0 always grows.
+ */
+uint64_t
+slice_growth_next_cap(slice_growth_t growth, const uint64_t cap, const uint64_t needed, const size_t elem_size);
+
+#endif /** end __SLICE_GROWTH_H */
+#ifdef __cplusplus
+}
+#endif
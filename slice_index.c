@@ -0,0 +1,329 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "slice_index.h"
+
+#define SLICE_INDEX_MIN_CAP 16
+#define SLICE_INDEX_MUL 0x9e3779b97f4a7c15ULL
+
+/**
+ * slice_index_slot maps a key to its home slot with a Fibonacci hash,
+ * taking the top bits of the product so keys that only differ in their
+ * high bits, or are multiples of a power of 2, still spread out.
+ */
+static inline uint64_t
+slice_index_slot(const slice_index_t *ix, const uint64_t key)
+{
+	return (key * SLICE_INDEX_MUL) >> ix->shift;
+}
+
+/**
+ * slice_index_find returns the slot holding key, or the empty slot its
+ * probe ends at. The table is never full so the probe always ends.
+ */
+static uint64_t
+slice_index_find(const slice_index_t *ix, const uint64_t key, slice_index_match_func_t match, const void *ctx)
+{
+	const uint64_t mask = ix->cap - 1;
+
+	for (uint64_t i = slice_index_slot(ix, key);; i = (i + 1) & mask) {
+		const slice_index_entry_t *e = &ix->entries[i];
+
+		if (e->count == 0) {
+			return i;
+		}
+		if (e->key == key && (match == NULL || match(ctx, ix->refs[i]))) {
+			return i;
+		}
+	}
+}
+
+/**
+ * slice_index_cap_for returns the number of slots that holds n keys while
+ * keeping the table at most 3/4 full.
+ */
+static uint64_t
+slice_index_cap_for(const uint64_t n)
+{
+	uint64_t cap = SLICE_INDEX_MIN_CAP;
+
+	while (cap / 4 * 3 < n) {
+		cap *= 2;
+	}
+
+	return cap;
+}
+
+/**
+ * slice_index_alloc replaces the table with an empty one of cap slots.
+ * The old table is returned through entries and refs for the caller to
+ * rehash and free. Returns -1 if the allocation fails, leaving the index
+ * as it was.
+ */
+static int
+slice_index_alloc(slice_index_t *ix, const uint64_t cap, slice_index_entry_t **entries, uint64_t **refs)
+{
+	slice_index_entry_t *e = slice_alloc(ix->allocator, sizeof(slice_index_entry_t) * cap);
+	uint64_t *r = NULL;
+
+	if (e == NULL) {
+		return -1;
+	}
+	if (ix->with_refs) {
+		r = slice_alloc(ix->allocator, sizeof(uint64_t) * cap);
+		if (r == NULL) {
+			slice_free(ix->allocator, e);
+			return -1;
+		}
+	}
+	memset(e, 0, sizeof(slice_index_entry_t) * cap);
+
+	*entries = ix->entries;
+	*refs = ix->refs;
+	ix->entries = e;
+	ix->refs = r;
+	ix->cap = cap;
+	ix->shift = 64 - (unsigned int)__builtin_ctzll(cap);
+
+	return 0;
+}
+
+static void
+slice_index_release(const slice_index_t *ix, slice_index_entry_t *entries, uint64_t *refs)
+{
+	if (entries != NULL) {
+		slice_free(ix->allocator, entries);
+	}
+	if (refs != NULL) {
+		slice_free(ix->allocator, refs);
+	}
+}
+
+/**
+ * slice_index_grow doubles the table. Keys already in it are distinct so
+ * they're moved to the first free slot of their probe without comparing
+ * items.
+ */
+static int
+slice_index_grow(slice_index_t *ix)
+{
+	const uint64_t old_cap = ix->cap;
+	slice_index_entry_t *entries;
+	uint64_t *refs;
+
+	if (slice_index_alloc(ix, old_cap == 0 ? SLICE_INDEX_MIN_CAP : old_cap * 2, &entries, &refs) != 0) {
+		return -1;
+	}
+
+	const uint64_t mask = ix->cap - 1;
+	for (uint64_t i = 0; i < old_cap; i++) {
+		if (entries[i].count == 0) {
+			continue;
+		}
+
+		uint64_t j = slice_index_slot(ix, entries[i].key);
+		while (ix->entries[j].count != 0) {
+			j = (j + 1) & mask;
+		}
+		ix->entries[j] = entries[i];
+		if (ix->with_refs) {
+			ix->refs[j] = refs[i];
+		}
+	}
+	slice_index_release(ix, entries, refs);
+
+	return 0;
+}
+
+slice_index_t*
+slice_index_new(const slice_allocator_t *allocator, const bool with_refs)
+{
+	slice_index_t *ix = slice_alloc(allocator, sizeof(slice_index_t));
+	if (ix == NULL) {
+		return NULL;
+	}
+	ix->entries = NULL;
+	ix->refs = NULL;
+	ix->cap = 0;
+	ix->used = 0;
+	ix->shift = 64;
+	ix->with_refs = with_refs;
+	ix->valid = false;
+	ix->allocator = allocator;
+
+	return ix;
+}
+
+void
+slice_index_free(slice_index_t *ix)
+{
+	if (ix == NULL) {
+		return;
+	}
+
+	slice_index_release(ix, ix->entries, ix->refs);
+	slice_free(ix->allocator, ix);
+}
+
+int
+slice_index_reset(slice_index_t *ix, const uint64_t n)
+{
+	const uint64_t cap = slice_index_cap_for(n);
+
+	ix->valid = false;
+	ix->used = 0;
+
+	if (cap <= ix->cap) {
+		memset(ix->entries, 0, sizeof(slice_index_entry_t) * ix->cap);
+	} else {
+		slice_index_entry_t *entries;
+		uint64_t *refs;
+
+		if (slice_index_alloc(ix, cap, &entries, &refs) != 0) {
+			return -1;
+		}
+		slice_index_release(ix, entries, refs);
+	}
+	ix->valid = true;
+
+	return 0;
+}
+
+int
+slice_index_add(slice_index_t *ix, const uint64_t key, const uint64_t ref, const uint64_t n, slice_index_match_func_t match, const void *ctx)
+{
+	if ((ix->used + 1) * 4 > ix->cap * 3 && slice_index_grow(ix) != 0) {
+		ix->valid = false;
+		return -1;
+	}
+
+	uint64_t i = slice_index_find(ix, key, match, ctx);
+	slice_index_entry_t *e = &ix->entries[i];
+
+	if (e->count == 0) {
+		e->key = key;
+		if (ix->with_refs) {
+			ix->refs[i] = ref;
+		}
+		ix->used++;
+	}
+	e->count += n;
+
+	return 0;
+}
+
+/**
+ * emptying a slot would cut the probes of the keys after it, so the entry
+ * is removed by backward shift: each following key whose home slot isn't
+ * between the hole and itself moves into the hole, until an empty slot.
+ */
+void
+slice_index_remove(slice_index_t *ix, const uint64_t key, const uint64_t n, slice_index_match_func_t match, const void *ctx)
+{
+	if (ix->cap == 0) {
+		return;
+	}
+
+	uint64_t i = slice_index_find(ix, key, match, ctx);
+	slice_index_entry_t *e = &ix->entries[i];
+
+	if (e->count == 0) {
+		return;
+	}
+	if (e->count > n) {
+		e->count -= n;
+		return;
+	}
+
+	const uint64_t mask = ix->cap - 1;
+	for (uint64_t j = (i + 1) & mask; ix->entries[j].count != 0; j = (j + 1) & mask) {
+		const uint64_t home = slice_index_slot(ix, ix->entries[j].key);
+
+		if (((j - home) & mask) < ((j - i) & mask)) {
+			continue;
+		}
+		ix->entries[i] = ix->entries[j];
+		if (ix->with_refs) {
+			ix->refs[i] = ix->refs[j];
+		}
+		i = j;
+	}
+	ix->entries[i].count = 0;
+	ix->used--;
+}
+
+uint64_t
+slice_index_count(const slice_index_t *ix, const uint64_t key, slice_index_match_func_t match, const void *ctx)
+{
+	if (ix->cap == 0) {
+		return 0;
+	}
+
+	return ix->entries[slice_index_find(ix, key, match, ctx)].count;
+}
+
+bool
+slice_index_lookup(const slice_index_t *ix, const uint64_t key, slice_index_match_func_t match, const void *ctx, uint64_t *ref)
+{
+	if (ix->cap == 0) {
+		return false;
+	}
+
+	uint64_t i = slice_index_find(ix, key, match, ctx);
+	if (ix->entries[i].count == 0) {
+		return false;
+	}
+	*ref = ix->refs[i];
+
+	return true;
+}
+
+uint64_t
+slice_index_bytes(const slice_index_t *ix)
+{
+	if (ix == NULL) {
+		return 0;
+	}
+
+	return sizeof(slice_index_t) + ix->cap * (sizeof(slice_index_entry_t) + (ix->with_refs ? sizeof(uint64_t) : 0));
+}
+
+/**
+ * slice_index_mix is the 64 bit finalizer of MurmurHash3.
+ */
+static inline uint64_t
+slice_index_mix(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	return h;
+}
+
+uint64_t
+slice_index_hash(const void *buf, const size_t len)
+{
+	const unsigned char *p = buf;
+	uint64_t h = SLICE_INDEX_MUL ^ len;
+	size_t n = len;
+	uint64_t w;
+
+	while (n >= 8) {
+		memcpy(&w, p, 8);
+		h = (h ^ slice_index_mix(w)) * SLICE_INDEX_MUL;
+		p += 8;
+		n -= 8;
+	}
+	if (n > 0) {
+		w = 0;
+		memcpy(&w, p, n);
+		h = (h ^ slice_index_mix(w)) * SLICE_INDEX_MUL;
+	}
+
+	return slice_index_mix(h);
+}
@@ -0,0 +1,142 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SLICE_INDEX_H
+#define __SLICE_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "slice_allocator.h"
+
+/**
+ * slice_index_t is an open addressing hash table counting the occurrences
+ * of each distinct item of a slice, so the slice can answer contains and
+ * count without scanning its items. Items are reduced to 64 bit keys: an
+ * integer item is its own key, other items are hashed. Tables created
+ * with refs also remember, for each key, the index of an item it came
+ * from, which lets hashed items that collide be told apart by comparing
+ * the items themselves.
+ *
+ * A slice builds an index once asked to, and its writes keep it up to
+ * date: appends add their items, deletes and replaces remove the items
+ * they drop, and writes that change most of the items rebuild it. Only
+ * writes the slice can't see, through a view or a raw pointer, mark it
+ * invalid, after which it's unused until the slice's index_build call.
+ * Queries never write to it.
+ */
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+} slice_index_entry_t;
+
+typedef struct {
+    slice_index_entry_t *entries;
+    uint64_t *refs;
+    uint64_t cap;
+    uint64_t used;
+    unsigned int shift;
+    bool with_refs;
+    bool valid;
+    const slice_allocator_t *allocator;
+} slice_index_t;
+
+/**
+ * slice_index_match_func_t reports whether the item at index ref of the
+ * slice is the one being looked up, ctx describing both.
+ */
+typedef bool (*slice_index_match_func_t)(const void *ctx, const uint64_t ref);
+
+/**
+ * slice_index_new creates an empty, invalid index taking its memory from
+ * the given allocator. Returns NULL if the allocation fails.
+ */
+slice_index_t*
+slice_index_new(const slice_allocator_t *allocator, const bool with_refs);
+
+/**
+ * slice_index_free frees the index and its table. A NULL index is
+ * ignored.
+ */
+void
+slice_index_free(slice_index_t *ix);
+
+/**
+ * slice_index_reset empties the index, making sure its table holds n
+ * distinct keys without growing, and marks it valid. A table that's
+ * already large enough is kept so rebuilding doesn't reallocate. Returns
+ * -1 if the table can't be allocated, leaving the index invalid.
+ */
+int
+slice_index_reset(slice_index_t *ix, const uint64_t n);
+
+/**
+ * slice_index_add records n more occurrences of key, growing the table if
+ * needed. match may be NULL when keys are the items themselves. Returns -1
+ * if the table can't grow, in which case the index is marked invalid.
+ */
+int
+slice_index_add(slice_index_t *ix, const uint64_t key, const uint64_t ref, const uint64_t n, slice_index_match_func_t match, const void *ctx);
+
+/**
+ * slice_index_remove forgets n occurrences of key, dropping its entry once
+ * none are left. A key the index doesn't hold is ignored.
+ */
+void
+slice_index_remove(slice_index_t *ix, const uint64_t key, const uint64_t n, slice_index_match_func_t match, const void *ctx);
+
+/**
+ * slice_index_count returns the number of occurrences recorded for key.
+ */
+uint64_t
+slice_index_count(const slice_index_t *ix, const uint64_t key, slice_index_match_func_t match, const void *ctx);
+
+/**
+ * slice_index_lookup stores the ref recorded for key in ref and returns
+ * true if the index holds key.
+ */
+bool
+slice_index_lookup(const slice_index_t *ix, const uint64_t key, slice_index_match_func_t match, const void *ctx, uint64_t *ref);
+
+/**
+ * slice_index_bytes returns the memory used by the index, 0 for a NULL
+ * index.
+ */
+uint64_t
+slice_index_bytes(const slice_index_t *ix);
+
+/**
+ * slice_index_hash returns a 64 bit hash of len bytes, used as the key of
+ * items that aren't integers.
+ */
+uint64_t
+slice_index_hash(const void *buf, const size_t len);
+
+/**
+ * slice_index_invalidate marks the index as out of date, so queries stop
+ * using it until it's rebuilt. A NULL index is ignored.
+ */
+static inline void
+slice_index_invalidate(slice_index_t *ix)
+{
+    if (ix != NULL) {
+        ix->valid = false;
+    }
+}
+
+/**
+ * slice_index_live returns true if the index is attached and up to date,
+ * the only case in which appends are added to it.
+ */
+static inline bool
+slice_index_live(const slice_index_t *ix)
+{
+    return ix != NULL && ix->valid;
+}
+
+#endif /** end __SLICE_INDEX_H */
+#ifdef __cplusplus
+}
+#endif
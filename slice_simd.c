@@ -0,0 +1,716 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "slice_simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SLICE_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * SLICE_SIMD_FIND_KERNEL defines a find kernel for one instruction set and
+ * element width. MASK yields a bit mask of the lanes of LANES items at p
+ * equal to val, with 1 << SHIFT bits per lane. The main loop only tests
+ * whether any of 4 vectors matched so it stays free of branches on the
+ * mask, the second loop then locates the exact lane.
+ */
+#define SLICE_SIMD_FIND_KERNEL(fn, attr, T, LANES, SHIFT, SETUP, MASK)           \
+attr static size_t                                                               \
+fn(const void *items, size_t n, T val)                                           \
+{                                                                                \
+	const T *p = items;                                                      \
+	size_t i = 0;                                                            \
+	SETUP;                                                                   \
+	                                                                         \
+	for (; i + 4 * (LANES) <= n; i += 4 * (LANES)) {                         \
+		uint64_t any = MASK(p + i) | MASK(p + i + (LANES)) |             \
+		    MASK(p + i + 2 * (LANES)) | MASK(p + i + 3 * (LANES));       \
+		if (any != 0) {                                                  \
+			break;                                                   \
+		}                                                                \
+	}                                                                        \
+	for (; i + (LANES) <= n; i += (LANES)) {                                 \
+		uint64_t m = MASK(p + i);                                        \
+		if (m != 0) {                                                    \
+			return i + ((size_t)__builtin_ctzll(m) >> (SHIFT));      \
+		}                                                                \
+	}                                                                        \
+	for (; i < n; i++) {                                                     \
+		if (p[i] == val) {                                               \
+			return i;                                                \
+		}                                                                \
+	}                                                                        \
+	                                                                         \
+	return n;                                                                \
+}
+
+#define SLICE_SIMD_SCALAR_SETUP (void)0
+#define SLICE_SIMD_SCALAR_MASK(q) ((uint64_t)(*(q) == val))
+
+/**
+ * SLICE_SIMD_SCALAR_MASK8 tests 8 items at once without a vector unit,
+ * letting the compiler combine the compares.
+ */
+#define SLICE_SIMD_SCALAR_MASK8(q)                                               \
+	((uint64_t)(((q)[0] == val) | ((q)[1] == val) | ((q)[2] == val) |        \
+	    ((q)[3] == val) | ((q)[4] == val) | ((q)[5] == val) |                \
+	    ((q)[6] == val) | ((q)[7] == val)))
+
+SLICE_SIMD_FIND_KERNEL(slice_find8_scalar, , uint8_t, 1, 0, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK)
+SLICE_SIMD_FIND_KERNEL(slice_find16_scalar, , uint16_t, 1, 0, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK)
+SLICE_SIMD_FIND_KERNEL(slice_find32_scalar, , uint32_t, 1, 0, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK)
+SLICE_SIMD_FIND_KERNEL(slice_find64_scalar, , uint64_t, 1, 0, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK)
+
+#ifdef SLICE_SIMD_X86
+
+#define SLICE_SSE2 __attribute__((target("sse2")))
+#define SLICE_AVX2 __attribute__((target("avx2")))
+#define SLICE_AVX512F __attribute__((target("avx512f")))
+#define SLICE_AVX512BW __attribute__((target("avx512f,avx512bw")))
+
+#define SLICE_SSE2_LOAD(q) _mm_loadu_si128((const __m128i*)(q))
+#define SLICE_AVX2_LOAD(q) _mm256_loadu_si256((const __m256i*)(q))
+#define SLICE_AVX512_LOAD(q) _mm512_loadu_si512((const void*)(q))
+
+#define SLICE_SSE2_MASK8(q) ((uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(SLICE_SSE2_LOAD(q), v)))
+#define SLICE_SSE2_MASK16(q) ((uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi16(SLICE_SSE2_LOAD(q), v)))
+#define SLICE_SSE2_MASK32(q) ((uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(SLICE_SSE2_LOAD(q), v))))
+
+/**
+ * SSE2 has no 64 bit compare, a 64 bit lane matches when both of its 32
+ * bit halves do.
+ */
+SLICE_SSE2 static inline uint64_t
+slice_sse2_mask64(const uint64_t *q, __m128i v)
+{
+	__m128i eq = _mm_cmpeq_epi32(SLICE_SSE2_LOAD(q), v);
+	eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	return (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+#define SLICE_SSE2_MASK64(q) slice_sse2_mask64((q), v)
+
+SLICE_SIMD_FIND_KERNEL(slice_find8_sse2, SLICE_SSE2, uint8_t, 16, 0,
+    const __m128i v = _mm_set1_epi8((char)val), SLICE_SSE2_MASK8)
+SLICE_SIMD_FIND_KERNEL(slice_find16_sse2, SLICE_SSE2, uint16_t, 8, 1,
+    const __m128i v = _mm_set1_epi16((short)val), SLICE_SSE2_MASK16)
+SLICE_SIMD_FIND_KERNEL(slice_find32_sse2, SLICE_SSE2, uint32_t, 4, 0,
+    const __m128i v = _mm_set1_epi32((int)val), SLICE_SSE2_MASK32)
+SLICE_SIMD_FIND_KERNEL(slice_find64_sse2, SLICE_SSE2, uint64_t, 2, 0,
+    const __m128i v = _mm_set1_epi64x((long long)val), SLICE_SSE2_MASK64)
+
+#define SLICE_AVX2_MASK8(q) ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(SLICE_AVX2_LOAD(q), v)))
+#define SLICE_AVX2_MASK16(q) ((uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(SLICE_AVX2_LOAD(q), v)))
+#define SLICE_AVX2_MASK32(q) ((uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(SLICE_AVX2_LOAD(q), v))))
+#define SLICE_AVX2_MASK64(q) ((uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(SLICE_AVX2_LOAD(q), v))))
+
+SLICE_SIMD_FIND_KERNEL(slice_find8_avx2, SLICE_AVX2, uint8_t, 32, 0,
+    const __m256i v = _mm256_set1_epi8((char)val), SLICE_AVX2_MASK8)
+SLICE_SIMD_FIND_KERNEL(slice_find16_avx2, SLICE_AVX2, uint16_t, 16, 1,
+    const __m256i v = _mm256_set1_epi16((short)val), SLICE_AVX2_MASK16)
+SLICE_SIMD_FIND_KERNEL(slice_find32_avx2, SLICE_AVX2, uint32_t, 8, 0,
+    const __m256i v = _mm256_set1_epi32((int)val), SLICE_AVX2_MASK32)
+SLICE_SIMD_FIND_KERNEL(slice_find64_avx2, SLICE_AVX2, uint64_t, 4, 0,
+    const __m256i v = _mm256_set1_epi64x((long long)val), SLICE_AVX2_MASK64)
+
+#define SLICE_AVX512_MASK8(q) ((uint64_t)_mm512_cmpeq_epi8_mask(SLICE_AVX512_LOAD(q), v))
+#define SLICE_AVX512_MASK16(q) ((uint64_t)_mm512_cmpeq_epi16_mask(SLICE_AVX512_LOAD(q), v))
+#define SLICE_AVX512_MASK32(q) ((uint64_t)_mm512_cmpeq_epi32_mask(SLICE_AVX512_LOAD(q), v))
+#define SLICE_AVX512_MASK64(q) ((uint64_t)_mm512_cmpeq_epi64_mask(SLICE_AVX512_LOAD(q), v))
+
+SLICE_SIMD_FIND_KERNEL(slice_find8_avx512, SLICE_AVX512BW, uint8_t, 64, 0,
+    const __m512i v = _mm512_set1_epi8((char)val), SLICE_AVX512_MASK8)
+SLICE_SIMD_FIND_KERNEL(slice_find16_avx512, SLICE_AVX512BW, uint16_t, 32, 0,
+    const __m512i v = _mm512_set1_epi16((short)val), SLICE_AVX512_MASK16)
+SLICE_SIMD_FIND_KERNEL(slice_find32_avx512, SLICE_AVX512F, uint32_t, 16, 0,
+    const __m512i v = _mm512_set1_epi32((int)val), SLICE_AVX512_MASK32)
+SLICE_SIMD_FIND_KERNEL(slice_find64_avx512, SLICE_AVX512F, uint64_t, 8, 0,
+    const __m512i v = _mm512_set1_epi64((long long)val), SLICE_AVX512_MASK64)
+
+#endif /** end SLICE_SIMD_X86 */
+
+/**
+ * SLICE_SIMD_REMOVE_KERNEL defines a kernel removing the items equal to val
+ * from the n items at p, keeping the others in order, and returning how
+ * many are left. Blocks of LANES items without a match are moved down in
+ * one go, and not at all before the first match, so removing a few items
+ * costs little more than finding them. Blocks with a match are compacted
+ * item by item, the write cursor only advancing past items that are kept.
+ */
+#define SLICE_SIMD_REMOVE_KERNEL(fn, attr, T, LANES, SETUP, MASK)                \
+attr static size_t                                                               \
+fn(void *items, size_t n, T val)                                                 \
+{                                                                                \
+	T *p = items;                                                            \
+	size_t i = 0;                                                            \
+	size_t j;                                                                \
+	SETUP;                                                                   \
+	                                                                         \
+	for (; i + (LANES) <= n && MASK(p + i) == 0; i += (LANES)) {             \
+	}                                                                        \
+	for (j = i; i + (LANES) <= n; i += (LANES)) {                            \
+		if (MASK(p + i) == 0) {                                          \
+			memmove(p + j, p + i, sizeof(T) * (LANES));              \
+			j += (LANES);                                            \
+			continue;                                                \
+		}                                                                \
+		for (size_t k = i; k < i + (LANES); k++) {                       \
+			T x = p[k];                                              \
+			p[j] = x;                                                \
+			j += x != val;                                           \
+		}                                                                \
+	}                                                                        \
+	for (; i < n; i++) {                                                     \
+		T x = p[i];                                                      \
+		p[j] = x;                                                        \
+		j += x != val;                                                   \
+	}                                                                        \
+	                                                                         \
+	return j;                                                                \
+}
+
+SLICE_SIMD_REMOVE_KERNEL(slice_remove8_scalar, , uint8_t, 8, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK8)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove16_scalar, , uint16_t, 8, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK8)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove32_scalar, , uint32_t, 8, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK8)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove64_scalar, , uint64_t, 8, SLICE_SIMD_SCALAR_SETUP, SLICE_SIMD_SCALAR_MASK8)
+
+#ifdef SLICE_SIMD_X86
+
+SLICE_SIMD_REMOVE_KERNEL(slice_remove8_avx2, SLICE_AVX2, uint8_t, 32,
+    const __m256i v = _mm256_set1_epi8((char)val), SLICE_AVX2_MASK8)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove16_avx2, SLICE_AVX2, uint16_t, 16,
+    const __m256i v = _mm256_set1_epi16((short)val), SLICE_AVX2_MASK16)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove32_avx2, SLICE_AVX2, uint32_t, 8,
+    const __m256i v = _mm256_set1_epi32((int)val), SLICE_AVX2_MASK32)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove64_avx2, SLICE_AVX2, uint64_t, 4,
+    const __m256i v = _mm256_set1_epi64x((long long)val), SLICE_AVX2_MASK64)
+
+/**
+ * SLICE_SIMD_COMPRESS_KERNEL defines a remove kernel for AVX-512, which
+ * packs the items of a vector that are kept with a single compress and
+ * stores the whole vector at the write cursor. The cursor never passes
+ * the read position so the store only overwrites items already loaded.
+ */
+#define SLICE_SIMD_COMPRESS_KERNEL(fn, attr, T, LANES, SET1, CMPNEQ, COMPRESS)   \
+attr static size_t                                                               \
+fn(void *items, size_t n, T val)                                                 \
+{                                                                                \
+	T *p = items;                                                            \
+	const __m512i v = SET1;                                                  \
+	size_t i = 0;                                                            \
+	size_t j = 0;                                                            \
+	                                                                         \
+	for (; i + (LANES) <= n; i += (LANES)) {                                 \
+		__m512i x = SLICE_AVX512_LOAD(p + i);                            \
+		uint64_t keep = (uint64_t)CMPNEQ(x, v);                          \
+		_mm512_storeu_si512((void*)(p + j), COMPRESS(keep, x));          \
+		j += (size_t)__builtin_popcountll(keep);                         \
+	}                                                                        \
+	for (; i < n; i++) {                                                     \
+		T x = p[i];                                                      \
+		p[j] = x;                                                        \
+		j += x != val;                                                   \
+	}                                                                        \
+	                                                                         \
+	return j;                                                                \
+}
+
+SLICE_SIMD_REMOVE_KERNEL(slice_remove8_avx512, SLICE_AVX512BW, uint8_t, 64,
+    const __m512i v = _mm512_set1_epi8((char)val), SLICE_AVX512_MASK8)
+SLICE_SIMD_REMOVE_KERNEL(slice_remove16_avx512, SLICE_AVX512BW, uint16_t, 32,
+    const __m512i v = _mm512_set1_epi16((short)val), SLICE_AVX512_MASK16)
+SLICE_SIMD_COMPRESS_KERNEL(slice_remove32_avx512, SLICE_AVX512F, uint32_t, 16,
+    _mm512_set1_epi32((int)val), _mm512_cmpneq_epi32_mask, _mm512_maskz_compress_epi32)
+SLICE_SIMD_COMPRESS_KERNEL(slice_remove64_avx512, SLICE_AVX512F, uint64_t, 8,
+    _mm512_set1_epi64((long long)val), _mm512_cmpneq_epi64_mask, _mm512_maskz_compress_epi64)
+
+#endif /** end SLICE_SIMD_X86 */
+
+/**
+ * SLICE_SIMD_COUNT_KERNEL defines a count kernel. The loop is left for the
+ * compiler to vectorize for the instruction set named by attr. Matches are
+ * summed in a counter as wide as the items, which keeps all lanes of the
+ * vector busy, and the blocks are short enough that it can't wrap before
+ * being added to the total.
+ */
+#define SLICE_SIMD_COUNT_KERNEL(fn, attr, T, BLOCK)                              \
+attr static size_t                                                               \
+fn(const void *items, size_t n, T val)                                           \
+{                                                                                \
+	const T *p = items;                                                      \
+	size_t count = 0;                                                        \
+	                                                                         \
+	while (n > 0) {                                                          \
+		size_t block = n < (BLOCK) ? n : (BLOCK);                        \
+		T c = 0;                                                         \
+		for (size_t i = 0; i < block; i++) {                             \
+			c += (T)(p[i] == val);                                   \
+		}                                                                \
+		count += c;                                                      \
+		p += block;                                                      \
+		n -= block;                                                      \
+	}                                                                        \
+	                                                                         \
+	return count;                                                            \
+}
+
+#define SLICE_SIMD_COUNT_KERNELS(suffix, attr8, attr32)                           \
+SLICE_SIMD_COUNT_KERNEL(slice_count8_##suffix, attr8, uint8_t, UINT8_MAX)         \
+SLICE_SIMD_COUNT_KERNEL(slice_count16_##suffix, attr8, uint16_t, UINT16_MAX)      \
+SLICE_SIMD_COUNT_KERNEL(slice_count32_##suffix, attr32, uint32_t, UINT32_MAX)     \
+SLICE_SIMD_COUNT_KERNEL(slice_count64_##suffix, attr32, uint64_t, SIZE_MAX)
+
+SLICE_SIMD_COUNT_KERNELS(scalar, , )
+#ifdef SLICE_SIMD_X86
+SLICE_SIMD_COUNT_KERNELS(avx2, SLICE_AVX2, SLICE_AVX2)
+SLICE_SIMD_COUNT_KERNELS(avx512, SLICE_AVX512BW, SLICE_AVX512F)
+#endif
+
+/**
+ * SLICE_SIMD_SUM_KERNEL defines a sum kernel, left for the compiler to
+ * vectorize like the count kernels. Items are added up in blocks into an
+ * accumulator ACC just wide enough not to overflow over BLOCK items, which
+ * fits more lanes in a vector than summing straight into 64 bits. Each
+ * block total is widened through WIDE and added to a 64 bit total that
+ * wraps on overflow.
+ */
+#define SLICE_SIMD_SUM_KERNEL(fn, attr, T, ACC, WIDE, BLOCK)                     \
+attr static uint64_t                                                             \
+fn(const void *items, size_t n)                                                  \
+{                                                                                \
+	const T *p = items;                                                      \
+	uint64_t total = 0;                                                      \
+	                                                                         \
+	while (n > 0) {                                                          \
+		size_t block = n < (BLOCK) ? n : (BLOCK);                        \
+		ACC acc = 0;                                                     \
+		for (size_t i = 0; i < block; i++) {                             \
+			acc += p[i];                                             \
+		}                                                                \
+		total += (uint64_t)(WIDE)acc;                                    \
+		p += block;                                                      \
+		n -= block;                                                      \
+	}                                                                        \
+	                                                                         \
+	return total;                                                            \
+}
+
+/**
+ * SLICE_SIMD_MINMAX_KERNEL defines a kernel finding the smallest and
+ * largest of n > 0 items in one pass. Both are kept as running selects the
+ * compiler turns into vector min and max instructions.
+ */
+#define SLICE_SIMD_MINMAX_KERNEL(fn, attr, T)                                    \
+attr static void                                                                 \
+fn(const void *items, size_t n, void *min, void *max)                            \
+{                                                                                \
+	const T *p = items;                                                      \
+	T lo = p[0];                                                             \
+	T hi = p[0];                                                             \
+	                                                                         \
+	for (size_t i = 1; i < n; i++) {                                         \
+		lo = p[i] < lo ? p[i] : lo;                                      \
+		hi = p[i] > hi ? p[i] : hi;                                      \
+	}                                                                        \
+	memcpy(min, &lo, sizeof(T));                                             \
+	memcpy(max, &hi, sizeof(T));                                             \
+}
+
+#define SLICE_SIMD_REDUCE_KERNELS(suffix, attr8, attr32)                                         \
+SLICE_SIMD_SUM_KERNEL(slice_sum_i8_##suffix, attr8, int8_t, int32_t, int64_t, (size_t)1 << 16)   \
+SLICE_SIMD_SUM_KERNEL(slice_sum_u8_##suffix, attr8, uint8_t, uint32_t, uint64_t, (size_t)1 << 16) \
+SLICE_SIMD_SUM_KERNEL(slice_sum_i16_##suffix, attr8, int16_t, int32_t, int64_t, (size_t)1 << 15) \
+SLICE_SIMD_SUM_KERNEL(slice_sum_u16_##suffix, attr8, uint16_t, uint32_t, uint64_t, (size_t)1 << 16) \
+SLICE_SIMD_SUM_KERNEL(slice_sum_i32_##suffix, attr32, int32_t, int64_t, int64_t, (size_t)1 << 31) \
+SLICE_SIMD_SUM_KERNEL(slice_sum_u32_##suffix, attr32, uint32_t, uint64_t, uint64_t, (size_t)1 << 31) \
+SLICE_SIMD_SUM_KERNEL(slice_sum_64_##suffix, attr32, uint64_t, uint64_t, uint64_t, SIZE_MAX)    \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_i8_##suffix, attr8, int8_t)                               \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_u8_##suffix, attr8, uint8_t)                              \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_i16_##suffix, attr8, int16_t)                             \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_u16_##suffix, attr8, uint16_t)                            \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_i32_##suffix, attr32, int32_t)                            \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_u32_##suffix, attr32, uint32_t)                           \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_i64_##suffix, attr32, int64_t)                            \
+SLICE_SIMD_MINMAX_KERNEL(slice_minmax_u64_##suffix, attr32, uint64_t)
+
+SLICE_SIMD_REDUCE_KERNELS(scalar, , )
+#ifdef SLICE_SIMD_X86
+SLICE_SIMD_REDUCE_KERNELS(avx2, SLICE_AVX2, SLICE_AVX2)
+SLICE_SIMD_REDUCE_KERNELS(avx512, SLICE_AVX512BW, SLICE_AVX512F)
+#endif
+
+/**
+ * the kernels in use start out as the scalar loops so calls made before
+ * slice_simd_init has run are still correct.
+ */
+static size_t (*slice_find8_impl)(const void*, size_t, uint8_t) = slice_find8_scalar;
+static size_t (*slice_find16_impl)(const void*, size_t, uint16_t) = slice_find16_scalar;
+static size_t (*slice_find32_impl)(const void*, size_t, uint32_t) = slice_find32_scalar;
+static size_t (*slice_find64_impl)(const void*, size_t, uint64_t) = slice_find64_scalar;
+static size_t (*slice_count8_impl)(const void*, size_t, uint8_t) = slice_count8_scalar;
+static size_t (*slice_count16_impl)(const void*, size_t, uint16_t) = slice_count16_scalar;
+static size_t (*slice_count32_impl)(const void*, size_t, uint32_t) = slice_count32_scalar;
+static size_t (*slice_count64_impl)(const void*, size_t, uint64_t) = slice_count64_scalar;
+static size_t (*slice_remove8_impl)(void*, size_t, uint8_t) = slice_remove8_scalar;
+static size_t (*slice_remove16_impl)(void*, size_t, uint16_t) = slice_remove16_scalar;
+static size_t (*slice_remove32_impl)(void*, size_t, uint32_t) = slice_remove32_scalar;
+static size_t (*slice_remove64_impl)(void*, size_t, uint64_t) = slice_remove64_scalar;
+static uint64_t (*slice_sum_i8_impl)(const void*, size_t) = slice_sum_i8_scalar;
+static uint64_t (*slice_sum_u8_impl)(const void*, size_t) = slice_sum_u8_scalar;
+static uint64_t (*slice_sum_i16_impl)(const void*, size_t) = slice_sum_i16_scalar;
+static uint64_t (*slice_sum_u16_impl)(const void*, size_t) = slice_sum_u16_scalar;
+static uint64_t (*slice_sum_i32_impl)(const void*, size_t) = slice_sum_i32_scalar;
+static uint64_t (*slice_sum_u32_impl)(const void*, size_t) = slice_sum_u32_scalar;
+static uint64_t (*slice_sum_64_impl)(const void*, size_t) = slice_sum_64_scalar;
+static void (*slice_minmax_i8_impl)(const void*, size_t, void*, void*) = slice_minmax_i8_scalar;
+static void (*slice_minmax_u8_impl)(const void*, size_t, void*, void*) = slice_minmax_u8_scalar;
+static void (*slice_minmax_i16_impl)(const void*, size_t, void*, void*) = slice_minmax_i16_scalar;
+static void (*slice_minmax_u16_impl)(const void*, size_t, void*, void*) = slice_minmax_u16_scalar;
+static void (*slice_minmax_i32_impl)(const void*, size_t, void*, void*) = slice_minmax_i32_scalar;
+static void (*slice_minmax_u32_impl)(const void*, size_t, void*, void*) = slice_minmax_u32_scalar;
+static void (*slice_minmax_i64_impl)(const void*, size_t, void*, void*) = slice_minmax_i64_scalar;
+static void (*slice_minmax_u64_impl)(const void*, size_t, void*, void*) = slice_minmax_u64_scalar;
+
+/**
+ * slice_simd_select points every kernel at the widest one the CPU supports
+ * up to the instruction set max, starting over from the scalar loops, and
+ * returns the level it reached.
+ */
+static slice_simd_level_t
+slice_simd_select(const slice_simd_level_t max)
+{
+	slice_simd_level_t level = SLICE_SIMD_SCALAR;
+
+	slice_find8_impl = slice_find8_scalar;
+	slice_find16_impl = slice_find16_scalar;
+	slice_find32_impl = slice_find32_scalar;
+	slice_find64_impl = slice_find64_scalar;
+	slice_count8_impl = slice_count8_scalar;
+	slice_count16_impl = slice_count16_scalar;
+	slice_count32_impl = slice_count32_scalar;
+	slice_count64_impl = slice_count64_scalar;
+	slice_remove8_impl = slice_remove8_scalar;
+	slice_remove16_impl = slice_remove16_scalar;
+	slice_remove32_impl = slice_remove32_scalar;
+	slice_remove64_impl = slice_remove64_scalar;
+	slice_sum_i8_impl = slice_sum_i8_scalar;
+	slice_sum_u8_impl = slice_sum_u8_scalar;
+	slice_sum_i16_impl = slice_sum_i16_scalar;
+	slice_sum_u16_impl = slice_sum_u16_scalar;
+	slice_sum_i32_impl = slice_sum_i32_scalar;
+	slice_sum_u32_impl = slice_sum_u32_scalar;
+	slice_sum_64_impl = slice_sum_64_scalar;
+	slice_minmax_i8_impl = slice_minmax_i8_scalar;
+	slice_minmax_u8_impl = slice_minmax_u8_scalar;
+	slice_minmax_i16_impl = slice_minmax_i16_scalar;
+	slice_minmax_u16_impl = slice_minmax_u16_scalar;
+	slice_minmax_i32_impl = slice_minmax_i32_scalar;
+	slice_minmax_u32_impl = slice_minmax_u32_scalar;
+	slice_minmax_i64_impl = slice_minmax_i64_scalar;
+	slice_minmax_u64_impl = slice_minmax_u64_scalar;
+
+#ifdef SLICE_SIMD_X86
+	__builtin_cpu_init();
+
+	if (max >= SLICE_SIMD_SSE2 && __builtin_cpu_supports("sse2")) {
+		level = SLICE_SIMD_SSE2;
+		slice_find8_impl = slice_find8_sse2;
+		slice_find16_impl = slice_find16_sse2;
+		slice_find32_impl = slice_find32_sse2;
+		slice_find64_impl = slice_find64_sse2;
+	}
+	if (max >= SLICE_SIMD_AVX2 && __builtin_cpu_supports("avx2")) {
+		level = SLICE_SIMD_AVX2;
+		slice_find8_impl = slice_find8_avx2;
+		slice_find16_impl = slice_find16_avx2;
+		slice_find32_impl = slice_find32_avx2;
+		slice_find64_impl = slice_find64_avx2;
+		slice_count8_impl = slice_count8_avx2;
+		slice_count16_impl = slice_count16_avx2;
+		slice_count32_impl = slice_count32_avx2;
+		slice_count64_impl = slice_count64_avx2;
+		slice_remove8_impl = slice_remove8_avx2;
+		slice_remove16_impl = slice_remove16_avx2;
+		slice_remove32_impl = slice_remove32_avx2;
+		slice_remove64_impl = slice_remove64_avx2;
+		slice_sum_i8_impl = slice_sum_i8_avx2;
+		slice_sum_u8_impl = slice_sum_u8_avx2;
+		slice_sum_i16_impl = slice_sum_i16_avx2;
+		slice_sum_u16_impl = slice_sum_u16_avx2;
+		slice_sum_i32_impl = slice_sum_i32_avx2;
+		slice_sum_u32_impl = slice_sum_u32_avx2;
+		slice_sum_64_impl = slice_sum_64_avx2;
+		slice_minmax_i8_impl = slice_minmax_i8_avx2;
+		slice_minmax_u8_impl = slice_minmax_u8_avx2;
+		slice_minmax_i16_impl = slice_minmax_i16_avx2;
+		slice_minmax_u16_impl = slice_minmax_u16_avx2;
+		slice_minmax_i32_impl = slice_minmax_i32_avx2;
+		slice_minmax_u32_impl = slice_minmax_u32_avx2;
+		slice_minmax_i64_impl = slice_minmax_i64_avx2;
+		slice_minmax_u64_impl = slice_minmax_u64_avx2;
+	}
+	if (max >= SLICE_SIMD_AVX512 && __builtin_cpu_supports("avx512f")) {
+		level = SLICE_SIMD_AVX512;
+		slice_find32_impl = slice_find32_avx512;
+		slice_find64_impl = slice_find64_avx512;
+		slice_count32_impl = slice_count32_avx512;
+		slice_count64_impl = slice_count64_avx512;
+		slice_remove32_impl = slice_remove32_avx512;
+		slice_remove64_impl = slice_remove64_avx512;
+		slice_sum_i32_impl = slice_sum_i32_avx512;
+		slice_sum_u32_impl = slice_sum_u32_avx512;
+		slice_sum_64_impl = slice_sum_64_avx512;
+		slice_minmax_i32_impl = slice_minmax_i32_avx512;
+		slice_minmax_u32_impl = slice_minmax_u32_avx512;
+		slice_minmax_i64_impl = slice_minmax_i64_avx512;
+		slice_minmax_u64_impl = slice_minmax_u64_avx512;
+	}
+	if (max >= SLICE_SIMD_AVX512 && __builtin_cpu_supports("avx512bw")) {
+		slice_find8_impl = slice_find8_avx512;
+		slice_find16_impl = slice_find16_avx512;
+		slice_count8_impl = slice_count8_avx512;
+		slice_count16_impl = slice_count16_avx512;
+		slice_remove8_impl = slice_remove8_avx512;
+		slice_remove16_impl = slice_remove16_avx512;
+		slice_sum_i8_impl = slice_sum_i8_avx512;
+		slice_sum_u8_impl = slice_sum_u8_avx512;
+		slice_sum_i16_impl = slice_sum_i16_avx512;
+		slice_sum_u16_impl = slice_sum_u16_avx512;
+		slice_minmax_i8_impl = slice_minmax_i8_avx512;
+		slice_minmax_u8_impl = slice_minmax_u8_avx512;
+		slice_minmax_i16_impl = slice_minmax_i16_avx512;
+		slice_minmax_u16_impl = slice_minmax_u16_avx512;
+	}
+#else
+	(void)max;
+#endif
+
+	return level;
+}
+
+/**
+ * slice_simd_init picks the widest kernels the CPU supports. It runs once
+ * when the library is loaded, before any thread can call into it.
+ */
+__attribute__((constructor)) static void
+slice_simd_init(void)
+{
+	slice_simd_select(SLICE_SIMD_AVX512);
+}
+
+slice_simd_level_t
+slice_simd_use(const slice_simd_level_t max)
+{
+	return slice_simd_select(max);
+}
+
+size_t
+slice_simd_find8(const void *items, size_t n, uint8_t val)
+{
+	return slice_find8_impl(items, n, val);
+}
+
+size_t
+slice_simd_find16(const void *items, size_t n, uint16_t val)
+{
+	return slice_find16_impl(items, n, val);
+}
+
+size_t
+slice_simd_find32(const void *items, size_t n, uint32_t val)
+{
+	return slice_find32_impl(items, n, val);
+}
+
+size_t
+slice_simd_find64(const void *items, size_t n, uint64_t val)
+{
+	return slice_find64_impl(items, n, val);
+}
+
+size_t
+slice_simd_count8(const void *items, size_t n, uint8_t val)
+{
+	return slice_count8_impl(items, n, val);
+}
+
+size_t
+slice_simd_count16(const void *items, size_t n, uint16_t val)
+{
+	return slice_count16_impl(items, n, val);
+}
+
+size_t
+slice_simd_count32(const void *items, size_t n, uint32_t val)
+{
+	return slice_count32_impl(items, n, val);
+}
+
+size_t
+slice_simd_count64(const void *items, size_t n, uint64_t val)
+{
+	return slice_count64_impl(items, n, val);
+}
+
+size_t
+slice_simd_remove8(void *items, size_t n, uint8_t val)
+{
+	return slice_remove8_impl(items, n, val);
+}
+
+size_t
+slice_simd_remove16(void *items, size_t n, uint16_t val)
+{
+	return slice_remove16_impl(items, n, val);
+}
+
+size_t
+slice_simd_remove32(void *items, size_t n, uint32_t val)
+{
+	return slice_remove32_impl(items, n, val);
+}
+
+size_t
+slice_simd_remove64(void *items, size_t n, uint64_t val)
+{
+	return slice_remove64_impl(items, n, val);
+}
+
+uint64_t
+slice_simd_sum_i8(const void *items, size_t n)
+{
+	return slice_sum_i8_impl(items, n);
+}
+
+uint64_t
+slice_simd_sum_u8(const void *items, size_t n)
+{
+	return slice_sum_u8_impl(items, n);
+}
+
+uint64_t
+slice_simd_sum_i16(const void *items, size_t n)
+{
+	return slice_sum_i16_impl(items, n);
+}
+
+uint64_t
+slice_simd_sum_u16(const void *items, size_t n)
+{
+	return slice_sum_u16_impl(items, n);
+}
+
+uint64_t
+slice_simd_sum_i32(const void *items, size_t n)
+{
+	return slice_sum_i32_impl(items, n);
+}
+
+uint64_t
+slice_simd_sum_u32(const void *items, size_t n)
+{
+	return slice_sum_u32_impl(items, n);
+}
+
+uint64_t
+slice_simd_sum_64(const void *items, size_t n)
+{
+	return slice_sum_64_impl(items, n);
+}
+
+void
+slice_simd_minmax_i8(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_i8_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_u8(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_u8_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_i16(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_i16_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_u16(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_u16_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_i32(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_i32_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_u32(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_u32_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_i64(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_i64_impl(items, n, min, max);
+}
+
+void
+slice_simd_minmax_u64(const void *items, size_t n, void *min, void *max)
+{
+	slice_minmax_u64_impl(items, n, min, max);
+}
+
+/**
+ * slice_add128 adds x, sign extended if is_signed is set, to the 128 bit
+ * two's complement number whose halves are *lo and *hi.
+ */
+static inline void
+slice_add128(uint64_t *lo, uint64_t *hi, const uint64_t x, const bool is_signed)
+{
+	*lo += x;
+	*hi += (uint64_t)(*lo < x);
+	if (is_signed && (x >> 63) != 0) {
+		*hi -= 1;
+	}
+}
+
+/**
+ * SLICE_SIMD_SUM_EXACT_CHUNK is how many items narrower than 64 bits can
+ * be summed by the wrapping kernels without leaving the 64 bit range.
+ */
+#define SLICE_SIMD_SUM_EXACT_CHUNK ((size_t)1 << 31)
+
+uint64_t
+slice_simd_sum_exact(const void *items, size_t n, size_t width, bool is_signed, uint64_t *hi)
+{
+	uint64_t lo = 0;
+
+	*hi = 0;
+
+	if (width == 8) {
+		const uint64_t *p = items;
+		for (size_t i = 0; i < n; i++) {
+			slice_add128(&lo, hi, p[i], is_signed);
+		}
+		return lo;
+	}
+
+	const unsigned char *p = items;
+	while (n > 0) {
+		size_t chunk = n < SLICE_SIMD_SUM_EXACT_CHUNK ? n : SLICE_SIMD_SUM_EXACT_CHUNK;
+		slice_add128(&lo, hi, slice_simd_sum(p, chunk, width, is_signed), is_signed);
+		p += chunk * width;
+		n -= chunk;
+	}
+
+	return lo;
+}
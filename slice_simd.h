@@ -0,0 +1,258 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SLICE_SIMD_H
+#define __SLICE_SIMD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * slice_simd_level_t names the instruction sets the kernels come in, from
+ * the narrowest up.
+ *
+ * SLICE_SIMD_SCALAR  plain loops, used where no vector unit is available.
+ * SLICE_SIMD_SSE2    SSE2, for the find kernels only.
+ * SLICE_SIMD_AVX2    AVX2.
+ * SLICE_SIMD_AVX512  AVX-512F, and AVX-512BW for the 8 and 16 bit kernels
+ *                    where the CPU has it.
+ */
+typedef enum {
+    SLICE_SIMD_SCALAR = 0,
+    SLICE_SIMD_SSE2,
+    SLICE_SIMD_AVX2,
+    SLICE_SIMD_AVX512,
+} slice_simd_level_t;
+
+/**
+ * slice_simd_use limits the kernels to the instruction sets up to max, so
+ * each one can be tested or benchmarked on its own, and returns the widest
+ * level the CPU supports within that limit. The kernels are picked without
+ * any locking, it mustn't be called while other threads use them.
+ */
+slice_simd_level_t
+slice_simd_use(const slice_simd_level_t max);
+
+/**
+ * slice_simd_find8, 16, 32 and 64 return the index of the first of the n
+ * items of the given width equal to val, or n if there is none. The kernel
+ * used is picked once at load time from the features of the CPU, falling
+ * back to a scalar loop where no vector unit is available.
+ */
+size_t
+slice_simd_find8(const void *items, size_t n, uint8_t val);
+
+size_t
+slice_simd_find16(const void *items, size_t n, uint16_t val);
+
+size_t
+slice_simd_find32(const void *items, size_t n, uint32_t val);
+
+size_t
+slice_simd_find64(const void *items, size_t n, uint64_t val);
+
+/**
+ * slice_simd_count8, 16, 32 and 64 return the number of the n items of
+ * the given width equal to val. They are dispatched the same way as the
+ * find kernels.
+ */
+size_t
+slice_simd_count8(const void *items, size_t n, uint8_t val);
+
+size_t
+slice_simd_count16(const void *items, size_t n, uint16_t val);
+
+size_t
+slice_simd_count32(const void *items, size_t n, uint32_t val);
+
+size_t
+slice_simd_count64(const void *items, size_t n, uint64_t val);
+
+/**
+ * slice_simd_remove8, 16, 32 and 64 remove the items of the given width
+ * equal to val from the n items, keeping the others in order, and return
+ * how many are left.
+ */
+size_t
+slice_simd_remove8(void *items, size_t n, uint8_t val);
+
+size_t
+slice_simd_remove16(void *items, size_t n, uint16_t val);
+
+size_t
+slice_simd_remove32(void *items, size_t n, uint32_t val);
+
+size_t
+slice_simd_remove64(void *items, size_t n, uint64_t val);
+
+/**
+ * slice_simd_sum_i8, u8, i16, u16, i32 and u32 return the sum of n signed
+ * or unsigned items of the given width, and slice_simd_sum_64 that of n
+ * 64 bit items of either kind. Signed sums are returned as the bits of an
+ * int64_t. All of them wrap modulo 2^64, which narrower items only reach
+ * past 2^31 of them. They're dispatched the same way as the find kernels.
+ */
+uint64_t
+slice_simd_sum_i8(const void *items, size_t n);
+
+uint64_t
+slice_simd_sum_u8(const void *items, size_t n);
+
+uint64_t
+slice_simd_sum_i16(const void *items, size_t n);
+
+uint64_t
+slice_simd_sum_u16(const void *items, size_t n);
+
+uint64_t
+slice_simd_sum_i32(const void *items, size_t n);
+
+uint64_t
+slice_simd_sum_u32(const void *items, size_t n);
+
+uint64_t
+slice_simd_sum_64(const void *items, size_t n);
+
+/**
+ * slice_simd_minmax_i8 to slice_simd_minmax_u64 store the smallest and
+ * largest of n items of the given width and signedness in min and max,
+ * found in a single pass. n must not be 0.
+ */
+void
+slice_simd_minmax_i8(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_u8(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_i16(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_u16(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_i32(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_u32(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_i64(const void *items, size_t n, void *min, void *max);
+
+void
+slice_simd_minmax_u64(const void *items, size_t n, void *min, void *max);
+
+/**
+ * slice_simd_sum_exact returns the low 64 bits of the exact sum of n items
+ * and stores the high 64 bits, two's complement for signed items, in hi.
+ * Items narrower than 64 bits still go through the vector kernels.
+ */
+uint64_t
+slice_simd_sum_exact(const void *items, size_t n, size_t width, bool is_signed, uint64_t *hi);
+
+/**
+ * slice_simd_find calls the find kernel matching an element width in
+ * bytes. width is expected to be a sizeof known at compile time so the
+ * switch folds away.
+ */
+static inline size_t
+slice_simd_find(const void *items, size_t n, size_t width, uint64_t val)
+{
+    switch (width) {
+    case 1:
+        return slice_simd_find8(items, n, (uint8_t)val);
+    case 2:
+        return slice_simd_find16(items, n, (uint16_t)val);
+    case 4:
+        return slice_simd_find32(items, n, (uint32_t)val);
+    default:
+        return slice_simd_find64(items, n, val);
+    }
+}
+
+/**
+ * slice_simd_count calls the count kernel matching an element width in
+ * bytes.
+ */
+static inline size_t
+slice_simd_count(const void *items, size_t n, size_t width, uint64_t val)
+{
+    switch (width) {
+    case 1:
+        return slice_simd_count8(items, n, (uint8_t)val);
+    case 2:
+        return slice_simd_count16(items, n, (uint16_t)val);
+    case 4:
+        return slice_simd_count32(items, n, (uint32_t)val);
+    default:
+        return slice_simd_count64(items, n, val);
+    }
+}
+
+/**
+ * slice_simd_remove calls the remove kernel matching an element width in
+ * bytes.
+ */
+static inline size_t
+slice_simd_remove(void *items, size_t n, size_t width, uint64_t val)
+{
+    switch (width) {
+    case 1:
+        return slice_simd_remove8(items, n, (uint8_t)val);
+    case 2:
+        return slice_simd_remove16(items, n, (uint16_t)val);
+    case 4:
+        return slice_simd_remove32(items, n, (uint32_t)val);
+    default:
+        return slice_simd_remove64(items, n, val);
+    }
+}
+
+/**
+ * slice_simd_sum calls the sum kernel matching an element width in bytes
+ * and signedness.
+ */
+static inline uint64_t
+slice_simd_sum(const void *items, size_t n, size_t width, bool is_signed)
+{
+    switch (width) {
+    case 1:
+        return is_signed ? slice_simd_sum_i8(items, n) : slice_simd_sum_u8(items, n);
+    case 2:
+        return is_signed ? slice_simd_sum_i16(items, n) : slice_simd_sum_u16(items, n);
+    case 4:
+        return is_signed ? slice_simd_sum_i32(items, n) : slice_simd_sum_u32(items, n);
+    default:
+        return slice_simd_sum_64(items, n);
+    }
+}
+
+/**
+ * slice_simd_minmax calls the minmax kernel matching an element width in
+ * bytes and signedness.
+ */
+static inline void
+slice_simd_minmax(const void *items, size_t n, size_t width, bool is_signed, void *min, void *max)
+{
+    switch (width) {
+    case 1:
+        is_signed ? slice_simd_minmax_i8(items, n, min, max) : slice_simd_minmax_u8(items, n, min, max);
+        break;
+    case 2:
+        is_signed ? slice_simd_minmax_i16(items, n, min, max) : slice_simd_minmax_u16(items, n, min, max);
+        break;
+    case 4:
+        is_signed ? slice_simd_minmax_i32(items, n, min, max) : slice_simd_minmax_u32(items, n, min, max);
+        break;
+    default:
+        is_signed ? slice_simd_minmax_i64(items, n, min, max) : slice_simd_minmax_u64(items, n, min, max);
+        break;
+    }
+}
+
+#endif /** end __SLICE_SIMD_H */
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,243 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slice_sort.h"
+
+/**
+ * inputs shorter than this are cheaper to introsort than to run through
+ * the radix passes, and partitions shorter than SLICE_SORT_INSERTION are
+ * finished with an insertion sort.
+ */
+#define SLICE_SORT_RADIX_MIN 256
+#define SLICE_SORT_INSERTION 16
+
+/**
+ * SLICE_SORT_INTRO defines an introsort over unsigned items of type T.
+ * Signed items are ordered by xoring flip, their sign bit, into both sides
+ * of every comparison. Quicksort with median of 3 pivots recurses on the
+ * smaller side, switching to heapsort once depth runs out so the worst
+ * case stays O(n log n).
+ */
+#define SLICE_SORT_INTRO(W, T)                                                   \
+static void                                                                      \
+slice_insertion##W(T *a, size_t n, T flip)                                       \
+{                                                                                \
+	for (size_t i = 1; i < n; i++) {                                         \
+		T x = a[i];                                                      \
+		size_t j = i;                                                    \
+		while (j > 0 && (T)(a[j - 1] ^ flip) > (T)(x ^ flip)) {          \
+			a[j] = a[j - 1];                                         \
+			j--;                                                     \
+		}                                                                \
+		a[j] = x;                                                        \
+	}                                                                        \
+}                                                                                \
+                                                                                 \
+static void                                                                      \
+slice_sift##W(T *a, size_t root, size_t n, T flip)                               \
+{                                                                                \
+	T x = a[root];                                                           \
+	size_t child;                                                            \
+	                                                                         \
+	while ((child = 2 * root + 1) < n) {                                     \
+		if (child + 1 < n && (T)(a[child] ^ flip) < (T)(a[child + 1] ^ flip)) { \
+			child++;                                                 \
+		}                                                                \
+		if ((T)(a[child] ^ flip) <= (T)(x ^ flip)) {                     \
+			break;                                                   \
+		}                                                                \
+		a[root] = a[child];                                              \
+		root = child;                                                    \
+	}                                                                        \
+	a[root] = x;                                                             \
+}                                                                                \
+                                                                                 \
+static void                                                                      \
+slice_heapsort##W(T *a, size_t n, T flip)                                        \
+{                                                                                \
+	for (size_t i = n / 2; i > 0; i--) {                                     \
+		slice_sift##W(a, i - 1, n, flip);                                \
+	}                                                                        \
+	for (size_t i = n - 1; i > 0; i--) {                                     \
+		T t = a[0];                                                      \
+		a[0] = a[i];                                                     \
+		a[i] = t;                                                        \
+		slice_sift##W(a, 0, i, flip);                                    \
+	}                                                                        \
+}                                                                                \
+                                                                                 \
+static void                                                                      \
+slice_introsort##W(T *a, size_t n, T flip, unsigned depth)                       \
+{                                                                                \
+	while (n > SLICE_SORT_INSERTION) {                                       \
+		if (depth-- == 0) {                                              \
+			slice_heapsort##W(a, n, flip);                           \
+			return;                                                  \
+		}                                                                \
+		                                                                 \
+		T lo = a[0] ^ flip, mid = a[n / 2] ^ flip, hi = a[n - 1] ^ flip; \
+		T pivot = lo < mid ? (mid < hi ? mid : (lo < hi ? hi : lo))      \
+		                   : (lo < hi ? lo : (mid < hi ? hi : mid));     \
+		size_t i = 0, j = n - 1;                                         \
+		for (;;) {                                                       \
+			while ((T)(a[i] ^ flip) < pivot) {                       \
+				i++;                                             \
+			}                                                        \
+			while ((T)(a[j] ^ flip) > pivot) {                       \
+				j--;                                             \
+			}                                                        \
+			if (i >= j) {                                            \
+				break;                                           \
+			}                                                        \
+			T t = a[i];                                              \
+			a[i++] = a[j];                                           \
+			a[j--] = t;                                              \
+		}                                                                \
+		                                                                 \
+		size_t left = j + 1;                                             \
+		if (left < n - left) {                                           \
+			slice_introsort##W(a, left, flip, depth);                \
+			a += left;                                               \
+			n -= left;                                               \
+		} else {                                                         \
+			slice_introsort##W(a + left, n - left, flip, depth);     \
+			n = left;                                                \
+		}                                                                \
+	}                                                                        \
+	slice_insertion##W(a, n, flip);                                          \
+}                                                                                \
+                                                                                 \
+static void                                                                      \
+slice_introsort_start##W(T *a, size_t n, T flip)                                 \
+{                                                                                \
+	unsigned depth = 0;                                                      \
+	for (size_t m = n; m > 1; m >>= 1) {                                     \
+		depth += 2;                                                      \
+	}                                                                        \
+	slice_introsort##W(a, n, flip, depth);                                   \
+}
+
+SLICE_SORT_INTRO(8, uint8_t)
+SLICE_SORT_INTRO(16, uint16_t)
+SLICE_SORT_INTRO(32, uint32_t)
+SLICE_SORT_INTRO(64, uint64_t)
+
+/**
+ * SLICE_SORT_RADIX defines an LSD radix sort over W bit unsigned items,
+ * one byte per pass. The histograms for every pass are gathered in a
+ * single read of the input, and passes where all items share the same
+ * digit are skipped, so e.g. small values in 64 bit slices only pay for
+ * the low bytes. The sign bit is flipped in the top digit for signed items.
+ */
+#define SLICE_SORT_RADIX(W, T)                                                   \
+static void                                                                      \
+slice_radix##W(T *a, size_t n, bool is_signed, const slice_allocator_t *allocator) \
+{                                                                                \
+	enum { passes = sizeof(T) };                                             \
+	const T flip = is_signed ? (T)((T)1 << (W - 1)) : 0;                     \
+	size_t counts[sizeof(T)][256];                                           \
+	                                                                         \
+	if (n < SLICE_SORT_RADIX_MIN) {                                          \
+		slice_introsort_start##W(a, n, flip);                            \
+		return;                                                          \
+	}                                                                        \
+	                                                                         \
+	T *tmp = slice_alloc(allocator, sizeof(T) * n);                          \
+	if (tmp == NULL) {                                                       \
+		slice_introsort_start##W(a, n, flip);                            \
+		return;                                                          \
+	}                                                                        \
+	                                                                         \
+	memset(counts, 0, sizeof(counts));                                       \
+	for (size_t i = 0; i < n; i++) {                                         \
+		T x = a[i] ^ flip;                                               \
+		for (unsigned p = 0; p < passes; p++) {                          \
+			counts[p][(x >> (8 * p)) & 0xff]++;                      \
+		}                                                                \
+	}                                                                        \
+	                                                                         \
+	T *src = a, *dst = tmp;                                                  \
+	for (unsigned p = 0; p < passes; p++) {                                  \
+		size_t *c = counts[p];                                           \
+		unsigned shift = 8 * p;                                          \
+		                                                                 \
+		if (c[(T)(src[0] ^ flip) >> shift & 0xff] == n) {                \
+			continue;                                                \
+		}                                                                \
+		                                                                 \
+		size_t sum = 0;                                                  \
+		for (unsigned d = 0; d < 256; d++) {                             \
+			size_t t = c[d];                                         \
+			c[d] = sum;                                              \
+			sum += t;                                                \
+		}                                                                \
+		for (size_t i = 0; i < n; i++) {                                 \
+			T x = src[i];                                            \
+			dst[c[(T)(x ^ flip) >> shift & 0xff]++] = x;             \
+		}                                                                \
+		                                                                 \
+		T *t = src;                                                      \
+		src = dst;                                                       \
+		dst = t;                                                         \
+	}                                                                        \
+	                                                                         \
+	if (src != a) {                                                          \
+		memcpy(a, src, sizeof(T) * n);                                   \
+	}                                                                        \
+	slice_free(allocator, tmp);                                              \
+}
+
+SLICE_SORT_RADIX(16, uint16_t)
+SLICE_SORT_RADIX(32, uint32_t)
+SLICE_SORT_RADIX(64, uint64_t)
+
+void
+slice_sort8(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator)
+{
+	uint8_t *a = items;
+	const uint8_t flip = is_signed ? 0x80 : 0;
+	size_t counts[256] = {0};
+
+	(void)allocator;
+
+	if (n < SLICE_SORT_RADIX_MIN) {
+		slice_introsort_start8(a, n, flip);
+		return;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		counts[a[i]]++;
+	}
+
+	/**
+	 * walk the buckets in key order, for signed items that starts at the
+	 * most negative value, 0x80.
+	 */
+	size_t k = 0;
+	for (unsigned d = 0; d < 256; d++) {
+		uint8_t x = (uint8_t)(d ^ flip);
+		memset(a + k, x, counts[x]);
+		k += counts[x];
+	}
+}
+
+void
+slice_sort16(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator)
+{
+	slice_radix16(items, n, is_signed, allocator);
+}
+
+void
+slice_sort32(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator)
+{
+	slice_radix32(items, n, is_signed, allocator);
+}
+
+void
+slice_sort64(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator)
+{
+	slice_radix64(items, n, is_signed, allocator);
+}
@@ -0,0 +1,60 @@
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __SLICE_SORT_H
+#define __SLICE_SORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "slice_allocator.h"
+
+/**
+ * slice_sort8, 16, 32 and 64 sort n integers of the given width into
+ * ascending order, treating them as two's complement when is_signed is
+ * set. 8 bit items are counting sorted, wider ones radix sorted a byte at
+ * a time using a scratch buffer the size of the input, taken from the
+ * given allocator, NULL meaning malloc. Short inputs, or ones for which
+ * the scratch buffer can't be allocated, are sorted in place with an
+ * introsort.
+ */
+void
+slice_sort8(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator);
+
+void
+slice_sort16(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator);
+
+void
+slice_sort32(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator);
+
+void
+slice_sort64(void *items, size_t n, bool is_signed, const slice_allocator_t *allocator);
+
+/**
+ * slice_sort calls the sort matching an element width in bytes.
+ */
+static inline void
+slice_sort(void *items, size_t n, size_t width, bool is_signed, const slice_allocator_t *allocator)
+{
+    switch (width) {
+    case 1:
+        slice_sort8(items, n, is_signed, allocator);
+        break;
+    case 2:
+        slice_sort16(items, n, is_signed, allocator);
+        break;
+    case 4:
+        slice_sort32(items, n, is_signed, allocator);
+        break;
+    default:
+        slice_sort64(items, n, is_signed, allocator);
+        break;
+    }
+}
+
+#endif /** end __SLICE_SORT_H */
+#ifdef __cplusplus
+}
+#endif
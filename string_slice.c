@@ -7,97 +7,521 @@
 #include <time.h>
 
 #include "string_slice.h"
+#include "slice_growth.h"
+
+/**
+ * string_slice_str returns the string of the given entry.
+ */
+static inline char*
+string_slice_str(char *bytes, const string_slice_entry_t e)
+{
+	return bytes + e.off;
+}
+
+/**
+ * string_slice_resize makes room for cap entries. Slices created with
+ * string_slice_new_inline keep their entries in the same allocation as the
+ * header so the first resize past that block copies them out to the heap
+ * instead of handing them to realloc. Returns -1 if the allocation fails.
+ */
+static int
+string_slice_resize(string_slice_t *s, const uint64_t cap)
+{
+	string_slice_entry_t *items;
+
+	if (s->items == s->inline_items) {
+		if (cap <= s->cap) {
+			return 0;
+		}
+
+		items = slice_alloc(s->allocator, sizeof(string_slice_entry_t) * cap);
+		if (items == NULL) {
+			return -1;
+		}
+		memcpy(items, s->items, sizeof(string_slice_entry_t) * s->len);
+	} else {
+		items = slice_realloc(s->allocator, s->items, sizeof(string_slice_entry_t) * s->cap, sizeof(string_slice_entry_t) * cap);
+		if (items == NULL) {
+			return -1;
+		}
+	}
+
+	s->items = items;
+	s->cap = cap;
+	s->reallocs++;
+
+	return 0;
+}
+
+/**
+ * string_slice_make_room makes sure n more entries fit after the current
+ * length, growing at most once according to the slice's growth policy.
+ */
+static int
+string_slice_make_room(string_slice_t *s, const uint64_t n)
+{
+	if (s->len + n <= s->cap) {
+		return 0;
+	}
+
+	uint64_t cap = slice_growth_next_cap(s->growth, s->cap, s->len + n, sizeof(string_slice_entry_t));
+
+	return string_slice_resize(s, cap);
+}
+
+/**
+ * string_slice_resize_bytes resizes the arena to cap bytes.
+ */
+static int
+string_slice_resize_bytes(string_slice_t *s, const uint64_t cap)
+{
+	char *bytes;
+
+	if (s->bytes == NULL) {
+		bytes = slice_alloc(s->allocator, cap);
+	} else {
+		bytes = slice_realloc(s->allocator, s->bytes, s->bytes_cap, cap);
+	}
+	if (bytes == NULL) {
+		return -1;
+	}
+
+	s->bytes = bytes;
+	s->bytes_cap = cap;
+	s->reallocs++;
+
+	return 0;
+}
+
+/**
+ * string_slice_make_bytes makes sure n more bytes fit in the arena,
+ * growing it at most once according to the slice's growth policy.
+ */
+static int
+string_slice_make_bytes(string_slice_t *s, const uint64_t n)
+{
+	if (s->bytes_len + n <= s->bytes_cap) {
+		return 0;
+	}
+
+	uint64_t cap = slice_growth_next_cap(s->growth, s->bytes_cap, s->bytes_len + n, 1);
+
+	return string_slice_resize_bytes(s, cap);
+}
+
+/**
+ * string_slice_entry_eq returns true if the entry holds the len bytes at
+ * val, whose hash is given. The bytes are only compared once the length
+ * and hash cached in the entry match.
+ */
+static inline bool
+string_slice_entry_eq(const char *bytes, const string_slice_entry_t e, const char *val, const uint64_t len, const uint64_t hash)
+{
+	return e.hash == hash && e.len == len && memcmp(bytes + e.off, val, len) == 0;
+}
+
+/**
+ * string_slice_match_t is what string_slice_match compares a string of
+ * the slice with.
+ */
+typedef struct {
+	char *bytes;
+	const char *val;
+	uint64_t len;
+} string_slice_match_t;
+
+/**
+ * string_slice_match tells strings whose hashes collide in the hash index
+ * and the interning table apart, ref being the arena offset of a string.
+ * Offsets, unlike entry indices, don't change when entries are deleted or
+ * reordered, and bytes stay in the arena until it's compacted. The stored
+ * string is NUL terminated so strncmp stops before reading past it.
+ */
+static bool
+string_slice_match(const void *ctx, const uint64_t ref)
+{
+	const string_slice_match_t *m = ctx;
+	const char *stored = m->bytes + ref;
+
+	return strncmp(stored, m->val, m->len) == 0 && stored[m->len] == '\0';
+}
+
+/**
+ * string_slice_store copies the len bytes at val to the end of the arena,
+ * followed by a NUL, and stores their offset in off. hash is their
+ * slice_index_hash. An interning slice looks val up first and reuses the
+ * bytes of an equal string. val may point into the arena itself. Returns
+ * -1 if the arena can't grow.
+ */
+static int
+string_slice_store(string_slice_t *s, const char *val, const uint64_t len, const uint64_t hash, uint64_t *off)
+{
+	string_slice_match_t m = {s->bytes, val, len};
+
+	if (slice_index_live(s->interned)) {
+		if (slice_index_lookup(s->interned, hash, string_slice_match, &m, off)) {
+			return 0;
+		}
+	}
+
+	/**
+	 * growing the arena moves a val that lives in it, so it's kept as an
+	 * offset across the resize.
+	 */
+	uintptr_t p = (uintptr_t)val;
+	uintptr_t base = (uintptr_t)s->bytes;
+	bool inside = s->bytes != NULL && p >= base && p < base + s->bytes_len;
+	uint64_t val_off = inside ? (uint64_t)(p - base) : 0;
+
+	if (string_slice_make_bytes(s, len + 1) != 0) {
+		return -1;
+	}
+	if (inside) {
+		val = s->bytes + val_off;
+	}
+
+	char *dst = s->bytes + s->bytes_len;
+	memcpy(dst, val, len);
+	dst[len] = '\0';
+	*off = s->bytes_len;
+	s->bytes_len += len + 1;
+
+	if (slice_index_live(s->interned)) {
+		m.bytes = s->bytes;
+		m.val = dst;
+		slice_index_add(s->interned, hash, *off, 1, string_slice_match, &m);
+	}
+
+	return 0;
+}
+
+/**
+ * string_slice_index_add adds the n strings starting at idx to the hash
+ * index, if the slice has an up to date one.
+ */
+static void
+string_slice_index_add(const string_slice_t *s, const uint64_t idx, const uint64_t n)
+{
+	if (!slice_index_live(s->index)) {
+		return;
+	}
+
+	for (uint64_t i = idx; i < idx + n; i++) {
+		const string_slice_entry_t e = s->items[i];
+		string_slice_match_t m = {s->bytes, string_slice_str(s->bytes, e), e.len};
+
+		if (slice_index_add(s->index, e.hash, e.off, 1, string_slice_match, &m) != 0) {
+			return;
+		}
+	}
+}
+
+/**
+ * string_slice_index_drop removes n occurrences of the len bytes at val,
+ * whose hash is given, from the hash index, if the slice has an up to date
+ * one. It's called before the entries holding them are dropped or written
+ * over.
+ */
+static void
+string_slice_index_drop(const string_slice_t *s, const char *val, const uint64_t len, const uint64_t hash, const uint64_t n)
+{
+	string_slice_match_t m = {s->bytes, val, len};
+
+	if (slice_index_live(s->index) && n != 0) {
+		slice_index_remove(s->index, hash, n, string_slice_match, &m);
+	}
+}
+
+/**
+ * string_slice_index_drop_entry is string_slice_index_drop for the string
+ * of one entry.
+ */
+static inline void
+string_slice_index_drop_entry(const string_slice_t *s, const string_slice_entry_t e)
+{
+	string_slice_index_drop(s, string_slice_str(s->bytes, e), e.len, e.hash, 1);
+}
+
+/**
+ * string_slice_index_rebuild rebuilds the hash index from the strings,
+ * for writes that change too many of them to follow one by one or that
+ * move the arena's bytes. Returns -1 if there's no index or it can't be
+ * built, leaving it stale.
+ */
+static int
+string_slice_index_rebuild(string_slice_t *s)
+{
+	slice_index_t *ix = s->index;
+
+	if (ix == NULL) {
+		return -1;
+	}
+	if (slice_index_reset(ix, 0) != 0) {
+		return -1;
+	}
+	string_slice_index_add(s, 0, s->len);
+
+	return ix->valid ? 0 : -1;
+}
+
+/**
+ * string_slice_index_ready returns the slice's hash index if it's up to
+ * date, or NULL if there's none or writes in place have left it stale.
+ * Queries only read the index, the slice's writes keep it up to date.
+ */
+static const slice_index_t*
+string_slice_index_ready(const string_slice_t *s)
+{
+	return slice_index_live(s->index) ? s->index : NULL;
+}
+
+/**
+ * string_slice_index_count looks val up in an up to date index.
+ */
+static uint64_t
+string_slice_index_count(const string_slice_t *s, const slice_index_t *ix, const char *val)
+{
+	string_slice_match_t m = {s->bytes, val, strlen(val)};
+
+	return slice_index_count(ix, slice_index_hash(val, m.len), string_slice_match, &m);
+}
+
+/**
+ * string_slice_init sets the fields every new slice starts with.
+ */
+static void
+string_slice_init(string_slice_t *s, const uint64_t cap, const slice_allocator_t *allocator)
+{
+	s->len = 0;
+	s->cap = cap;
+	s->bytes = NULL;
+	s->bytes_len = 0;
+	s->bytes_cap = 0;
+	s->allocator = allocator;
+	s->growth = SLICE_GROWTH_DOUBLE;
+	s->reallocs = 0;
+	s->index = NULL;
+	s->interned = NULL;
+}
 
 string_slice_t*
 string_slice_new(const uint64_t cap)
 {
-    string_slice_t *s = calloc(1, sizeof(string_slice_t));
-    s->items = calloc(1, sizeof(char*) * cap);
-    s->len = 0;
-    s->cap = cap;
+	return string_slice_new_with_allocator(cap, NULL);
+}
+
+string_slice_t*
+string_slice_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator)
+{
+	string_slice_t *s = slice_alloc(allocator, sizeof(string_slice_t));
+	if (s == NULL) {
+		return NULL;
+	}
+
+	s->items = slice_alloc(allocator, sizeof(string_slice_entry_t) * cap);
+	if (s->items == NULL && cap != 0) {
+		slice_free(allocator, s);
+		return NULL;
+	}
+	string_slice_init(s, cap, allocator);
+
+	return s;
+}
+
+string_slice_t*
+string_slice_new_inline(const uint64_t cap)
+{
+	return string_slice_new_inline_with_allocator(cap, NULL);
+}
+
+string_slice_t*
+string_slice_new_inline_with_allocator(const uint64_t cap, const slice_allocator_t *allocator)
+{
+	string_slice_t *s = slice_alloc(allocator, sizeof(string_slice_t) + sizeof(string_slice_entry_t) * cap);
+	if (s == NULL) {
+		return NULL;
+	}
+	s->items = s->inline_items;
+	string_slice_init(s, cap, allocator);
 
-    return s;
+	return s;
 }
 
 void
-string_slice_free(string_slice_t *s) {
-	if (s != NULL && s->items != NULL) {
-        free(s->items);
-        free(s);
-	} 
+string_slice_free(string_slice_t *s)
+{
+	if (s == NULL) {
+		return;
+	}
+
+	if (s->items != s->inline_items) {
+		slice_free(s->allocator, s->items);
+	}
+	if (s->bytes != NULL) {
+		slice_free(s->allocator, s->bytes);
+	}
+	slice_index_free(s->index);
+	slice_index_free(s->interned);
+	slice_free(s->allocator, s);
 }
 
 char*
 string_slice_get(string_slice_t *s, uint64_t idx)
 {
-    if (idx >= 0 && idx < s->len) {
-        return s->items[idx];
-    }
+	if (idx < s->len) {
+		return string_slice_str(s->bytes, s->items[idx]);
+	}
 
-    return 0;
+	return 0;
 }
 
 void
 string_slice_append(string_slice_t *s, const char *val)
 {
-    if (s->len == s->cap) {
-        s->cap *= 2;
-        s->items = realloc(s->items, sizeof(char*) * s->cap);
-    }
-	strcpy(s->items[s->len++], val);
+	string_slice_append_len(s, val, strlen(val));
 }
 
-void
-string_slice_reverse(string_slice_t *s) {
-	if (s->len < 2) {
+/**
+ * string_slice_push appends the len bytes at val, whose hash is already
+ * known, as a string.
+ */
+static void
+string_slice_push(string_slice_t *s, const char *val, const uint64_t len, const uint64_t hash)
+{
+	string_slice_entry_t e = {0, len, hash};
+
+	if (string_slice_make_room(s, 1) != 0 || string_slice_store(s, val, len, hash, &e.off) != 0) {
 		return;
 	}
+	s->items[s->len] = e;
+	s->len++;
+	string_slice_index_add(s, s->len - 1, 1);
+}
+
+void
+string_slice_append_len(string_slice_t *s, const char *val, const size_t len)
+{
+	string_slice_push(s, val, len, slice_index_hash(val, len));
+}
 
-    uint64_t i = s->len - 1;
-    uint64_t j = 0;
+int64_t
+string_slice_insert(string_slice_t *s, const uint64_t idx, const char *val)
+{
+	string_slice_entry_t e = {0, strlen(val), 0};
 
-    while(i > j) {
-        char *temp = s->items[i];
-        s->items[i] = s->items[j];
-        s->items[j] = temp;
-        i--;
-        j++;
-    }
+	if (idx > s->len) {
+		return -1;
+	}
+	e.hash = slice_index_hash(val, e.len);
+	if (string_slice_make_room(s, 1) != 0 || string_slice_store(s, val, e.len, e.hash, &e.off) != 0) {
+		return -1;
+	}
+
+	memmove(s->items + idx + 1, s->items + idx, sizeof(string_slice_entry_t) * (s->len - idx));
+	s->items[idx] = e;
+	s->len++;
+	string_slice_index_add(s, idx, 1);
+
+	return (int64_t)s->len;
 }
 
-bool
-string_slice_compare(const string_slice_t *s1, const string_slice_t *s2, compare_func_t compare, void *user_data)
+int64_t
+string_slice_insert_n(string_slice_t *s, const uint64_t idx, const char *const *vals, const uint64_t n)
 {
-	if (s1->len != s2->len) {
-		return false;
+	uint64_t bytes = 0;
+
+	if (idx > s->len) {
+		return -1;
+	}
+	for (uint64_t i = 0; i < n; i++) {
+		bytes += strlen(vals[i]) + 1;
+	}
+	if (string_slice_make_room(s, n) != 0 || string_slice_make_bytes(s, bytes) != 0) {
+		return -1;
+	}
+	if (n == 0) {
+		return (int64_t)s->len;
 	}
 
-	for (uint64_t i = 0; i < s1->len; i++) {
-		if (!compare(s1->items[i], s2->items[i], user_data)) {
-			return false;
-		}
+	memmove(s->items + idx + n, s->items + idx, sizeof(string_slice_entry_t) * (s->len - idx));
+	for (uint64_t i = 0; i < n; i++) {
+		string_slice_entry_t *e = &s->items[idx + i];
+
+		e->len = strlen(vals[i]);
+		e->hash = slice_index_hash(vals[i], e->len);
+		string_slice_store(s, vals[i], e->len, e->hash, &e->off);
 	}
+	s->len += n;
+	string_slice_index_add(s, idx, n);
 
-	return true;
+	return (int64_t)s->len;
+}
+
+void
+string_slice_reverse(string_slice_t *s)
+{
+	if (s->len < 2) {
+		return;
+	}
+
+	uint64_t i = s->len - 1;
+	uint64_t j = 0;
+
+	while (i > j) {
+		string_slice_entry_t temp = s->items[i];
+		s->items[i] = s->items[j];
+		s->items[j] = temp;
+		i--;
+		j++;
+	}
+}
+
+bool
+string_slice_compare(const string_slice_t *s1, const string_slice_t *s2, string_slice_compare_func_t compare, void *user_data)
+{
+	return string_slice_view_compare(string_slice_as_view(s1), string_slice_as_view(s2), compare, user_data);
 }
 
 uint64_t
 string_slice_copy(const string_slice_t *s1, string_slice_t *s2, bool overwrite)
 {
-	if (s2->len == 0) {
-		return 0;
+	const uint64_t n = s1->len < s2->len ? s1->len : s2->len;
+
+	if (s1 == s2) {
+		return n;
 	}
+	if (!overwrite) {
+		for (uint64_t i = 0; i < n; i++) {
+			string_slice_entry_t e = s1->items[i];
 
-	if (overwrite) {
-		if (s1->len != s2->len) {
-			s2->cap = s1->cap;
-			s2->items = realloc(s2->items, sizeof(char*) * s1->cap);
+			if (string_slice_store(s2, string_slice_str(s1->bytes, e), e.len, e.hash, &e.off) != 0) {
+				return i;
+			}
+			string_slice_index_drop_entry(s2, s2->items[i]);
+			s2->items[i] = e;
+			string_slice_index_add(s2, i, 1);
 		}
+
+		return n;
+	}
+
+	s2->len = 0;
+	s2->bytes_len = 0;
+	slice_index_invalidate(s2->index);
+	if (s2->interned != NULL && slice_index_reset(s2->interned, 0) != 0) {
+		slice_index_invalidate(s2->interned);
 	}
 
+	if (string_slice_make_room(s2, s1->len) != 0 || string_slice_make_bytes(s2, s1->bytes_len) != 0) {
+		return 0;
+	}
 	for (uint64_t i = 0; i < s1->len; i++) {
-		s2->items[i] = s1->items[i];
-		s2->len++;
+		const string_slice_entry_t e = s1->items[i];
+
+		string_slice_push(s2, string_slice_str(s1->bytes, e), e.len, e.hash);
+	}
+	if (s2->index != NULL) {
+		string_slice_index_rebuild(s2);
 	}
 
 	return s2->len;
@@ -106,30 +530,112 @@ string_slice_copy(const string_slice_t *s1, string_slice_t *s2, bool overwrite)
 bool
 string_slice_contains(const string_slice_t *s, char *val)
 {
-	if (s->len == 0) {
-		return false;
-	}
+	const slice_index_t *ix = string_slice_index_ready(s);
 
-	for (uint64_t i = 0; i < s->len; i++) {
-		if (s->items[i] == val) {
-			return true;
-		}
+	if (ix != NULL) {
+		return string_slice_index_count(s, ix, val) != 0;
 	}
 
-	return false;
+	return string_slice_view_contains(string_slice_as_view(s), val);
 }
 
 int
 string_slice_delete(string_slice_t *s, const uint64_t idx)
 {
-	if (s->len == 0 || idx > s->len) {
+	if (idx >= s->len) {
 		return -1;
 	}
 
-	for (uint64_t i = idx; i < s->len; i++) {
-		s->items[i] = s->items[i + 1];
+	string_slice_index_drop_entry(s, s->items[idx]);
+	memmove(s->items + idx, s->items + idx + 1, sizeof(string_slice_entry_t) * (s->len - idx - 1));
+	s->len--;
+
+	return s->len;
+}
+
+int64_t
+string_slice_swap_remove(string_slice_t *s, const uint64_t idx)
+{
+	if (idx >= s->len) {
+		return -1;
 	}
+
+	string_slice_index_drop_entry(s, s->items[idx]);
 	s->len--;
+	s->items[idx] = s->items[s->len];
+
+	return (int64_t)s->len;
+}
+
+int64_t
+string_slice_delete_indices(string_slice_t *s, const size_t *idx, const size_t n)
+{
+	uint64_t j;
+
+	if (n == 0) {
+		return (int64_t)s->len;
+	}
+	for (size_t k = 0; k < n; k++) {
+		if (idx[k] >= s->len || (k > 0 && idx[k] < idx[k - 1])) {
+			return -1;
+		}
+	}
+	for (size_t k = 0; k < n; k++) {
+		if (k == 0 || idx[k] != idx[k - 1]) {
+			string_slice_index_drop_entry(s, s->items[idx[k]]);
+		}
+	}
+
+	j = idx[0];
+	for (size_t k = 0; k < n; k++) {
+		uint64_t lo = idx[k] + 1;
+		uint64_t hi = k + 1 < n ? idx[k + 1] : s->len;
+
+		if (lo > hi) {
+			continue;
+		}
+		memmove(s->items + j, s->items + lo, sizeof(string_slice_entry_t) * (hi - lo));
+		j += hi - lo;
+	}
+	s->len = j;
+
+	return (int64_t)s->len;
+}
+
+uint64_t
+string_slice_retain(string_slice_t *s, string_slice_pred_func_t pred, void *user_data)
+{
+	uint64_t j = 0;
+
+	for (uint64_t i = 0; i < s->len; i++) {
+		const string_slice_entry_t e = s->items[i];
+
+		if (pred(string_slice_str(s->bytes, e), user_data)) {
+			s->items[j++] = e;
+		} else {
+			string_slice_index_drop_entry(s, e);
+		}
+	}
+	s->len = j;
+
+	return s->len;
+}
+
+uint64_t
+string_slice_remove_value(string_slice_t *s, const char *val)
+{
+	const uint64_t len = strlen(val);
+	const uint64_t hash = slice_index_hash(val, len);
+	uint64_t j = 0;
+
+	for (uint64_t i = 0; i < s->len; i++) {
+		const string_slice_entry_t e = s->items[i];
+
+		s->items[j] = e;
+		j += !string_slice_entry_eq(s->bytes, e, val, len, hash);
+	}
+	string_slice_index_drop(s, val, len, hash, s->len - j);
+	s->len = j;
 
 	return s->len;
 }
@@ -137,24 +643,54 @@ string_slice_delete(string_slice_t *s, const uint64_t idx)
 int
 string_slice_replace_by_idx(string_slice_t *s, const uint64_t idx, const char *val)
 {
-	if (s->len == 0 || idx > s->len) {
+	string_slice_entry_t e = {0, strlen(val), 0};
+
+	if (idx >= s->len) {
+		return -1;
+	}
+	e.hash = slice_index_hash(val, e.len);
+	if (string_slice_store(s, val, e.len, e.hash, &e.off) != 0) {
 		return -1;
 	}
-	strcpy(s->items[idx], val);
+	string_slice_index_drop_entry(s, s->items[idx]);
+	s->items[idx] = e;
+	string_slice_index_add(s, idx, 1);
 
 	return 0;
 }
 
 int
-string_slice_replace_by_val(string_slice_t *s, const char *old_val, const char *new_val, uint64_t times, compare_func_t compare)
+string_slice_replace_by_val(string_slice_t *s, const char *old_val, const char *new_val, uint64_t times, string_slice_compare_func_t compare)
 {
+	string_slice_entry_t repl = {0, strlen(new_val), 0};
+	const uint64_t old_len = strlen(old_val);
+	const uint64_t old_hash = slice_index_hash(old_val, old_len);
+	bool stored = false;
+
 	if (s->len == 0) {
 		return -1;
 	}
+	repl.hash = slice_index_hash(new_val, repl.len);
+
+	/**
+	 * old_val may point into the arena, so the room for new_val is made
+	 * up front and storing it on the first match can't move the arena.
+	 */
+	if (string_slice_make_bytes(s, repl.len + 1) != 0) {
+		return -1;
+	}
 
 	for (uint64_t i = 0; i < s->len && times != 0; i++) {
-		if (compare(s->items[i], old_val, NULL)) {
-			strcpy(s->items[i], new_val);
+		const string_slice_entry_t e = s->items[i];
+
+		if (compare == NULL ? string_slice_entry_eq(s->bytes, e, old_val, old_len, old_hash) : compare(string_slice_str(s->bytes, e), old_val, NULL)) {
+			if (!stored) {
+				string_slice_store(s, new_val, repl.len, repl.hash, &repl.off);
+				stored = true;
+			}
+			string_slice_index_drop_entry(s, e);
+			s->items[i] = repl;
+			string_slice_index_add(s, i, 1);
 			times--;
 		}
 	}
@@ -171,72 +707,104 @@ string_slice_first(string_slice_t *s)
 char*
 string_slice_last(string_slice_t *s)
 {
-	return string_slice_get(s, s->len-1);
+	return string_slice_get(s, s->len - 1);
 }
 
 int
-string_slice_foreach(string_slice_t *s, foreach_func_t ift, void *user_data)
+string_slice_foreach(string_slice_t *s, string_slice_foreach_func_t ift, void *user_data)
 {
-	if (s->len == 0) {
-		return 0;
-	}
-	
-	for (uint64_t i = 0; i < s->len; i++) {
-		ift(s->items[i], user_data);
-	}
-
-	return 0;
+	return string_slice_view_foreach(string_slice_as_view(s), ift, user_data);
 }
 
 /**
- * qsort_compare is a simple implementation of the function required to be
- * passed to qsort.
+ * string_slice_sort_item_t pairs a string with its entry while sorting.
+ * The string comes first so a sort_compare written for an array of char*
+ * sees one.
+ */
+typedef struct {
+	char *str;
+	string_slice_entry_t entry;
+} string_slice_sort_item_t;
+
+/**
+ * qsort_compare orders the strings pointed to by x and y with strcmp. It's
+ * used when no sort function is given.
  */
 static int
-qsort_compare(const void *x, const void *y) {
-	return (*(int*)x - *(int*)y);
+qsort_compare(const void *x, const void *y)
+{
+	return strcmp(*(char* const*)x, *(char* const*)y);
 }
 
-void
-string_slice_sort(string_slice_t *s, sort_compare_func_t sort_compare)
+/**
+ * string_slice_sort_entries sorts n entries by their strings through a
+ * scratch array of string_slice_sort_item_t, leaving them as they were if
+ * it can't be allocated.
+ */
+static void
+string_slice_sort_entries(char *bytes, string_slice_entry_t *items, const uint64_t n, sort_compare_func_t sort_compare, const slice_allocator_t *allocator)
 {
-	if (s->len < 2) {
+	string_slice_sort_item_t *tmp;
+
+	if (n < 2) {
+		return;
+	}
+
+	tmp = slice_alloc(allocator, sizeof(string_slice_sort_item_t) * n);
+	if (tmp == NULL) {
 		return;
 	}
+	for (uint64_t i = 0; i < n; i++) {
+		tmp[i].str = string_slice_str(bytes, items[i]);
+		tmp[i].entry = items[i];
+	}
+
+	qsort(tmp, n, sizeof(string_slice_sort_item_t), sort_compare == NULL ? qsort_compare : sort_compare);
 
-	if (sort_compare == NULL) {
-		return ;
+	for (uint64_t i = 0; i < n; i++) {
+		items[i] = tmp[i].entry;
 	}
+	slice_free(allocator, tmp);
+}
 
-	qsort(s->items, s->len, sizeof(char*), sort_compare);
+void
+string_slice_sort(string_slice_t *s, sort_compare_func_t sort_compare)
+{
+	string_slice_sort_entries(s->bytes, s->items, s->len, sort_compare, s->allocator);
 }
 
 uint64_t
 string_slice_repeat(string_slice_t *s, const char *val, const uint64_t times)
 {
+	string_slice_entry_t e = {0, strlen(val), 0};
+
+	if (times == 0) {
+		return s->len;
+	}
+	e.hash = slice_index_hash(val, e.len);
+	if (string_slice_make_room(s, times) != 0 || string_slice_store(s, val, e.len, e.hash, &e.off) != 0) {
+		return s->len;
+	}
+
 	for (uint64_t i = 0; i < times; i++) {
-		string_slice_append(s, val);
+		s->items[s->len + i] = e;
 	}
+	s->len += times;
+	string_slice_index_add(s, s->len - times, times);
 
 	return s->len;
 }
 
 uint64_t
-string_slice_count(string_slice_t *s, const char *val, compare_func_t compare)
+string_slice_count(string_slice_t *s, const char *val, string_slice_compare_func_t compare)
 {
-	uint64_t count = 0;
+	const slice_index_t *ix = compare == NULL ? string_slice_index_ready(s) : NULL;
 
-	if (s->len == 0) {
-		return count;
+	if (ix != NULL) {
+		return string_slice_index_count(s, ix, val);
 	}
 
-	for (uint64_t i = 0; i < s->len; i++) {
-		if (compare(s->items[i], val, NULL)) {
-			count++;
-		}
-	}
-
-	return count;
+	return string_slice_view_count(string_slice_as_view(s), val, compare);
 }
 
 uint64_t
@@ -246,8 +814,7 @@ string_slice_grow(string_slice_t *s, const uint64_t size)
 		return s->cap;
 	}
 
-	s->cap += size;
-    s->items = realloc(s->items, sizeof(char*) * s->cap);
+	string_slice_resize(s, s->cap + size);
 
 	return s->cap;
 }
@@ -255,17 +822,361 @@ string_slice_grow(string_slice_t *s, const uint64_t size)
 uint64_t
 string_slice_concat(string_slice_t *s1, const string_slice_t *s2)
 {
-	if (s2->len == 0) {
+	const uint64_t n = s2->len;
+
+	if (n == 0) {
 		return s1->len;
 	}
-	
-	s1->cap += s2->len;
-	s1->items = realloc(s1->items, sizeof(char*) * s2->len);
 
-	for (uint64_t i = 0, j = s1->len; i < s2->len; i++, j++) {
-		s1->items[j] = s2->items[i];
-		s1->len++;
+	if (string_slice_make_room(s1, n) != 0 || string_slice_make_bytes(s1, s2->bytes_len) != 0) {
+		return s1->len;
 	}
-	
+
+	/**
+	 * s2 may be s1, so its entries and bytes are read through s2 after s1
+	 * has grown, and only the n entries it had to begin with.
+	 */
+	for (uint64_t i = 0; i < n; i++) {
+		const string_slice_entry_t e = s2->items[i];
+
+		string_slice_push(s1, string_slice_str(s2->bytes, e), e.len, e.hash);
+	}
+
 	return s1->len;
 }
+
+void
+string_slice_set_growth(string_slice_t *s, const slice_growth_t growth)
+{
+	s->growth = growth;
+}
+
+uint64_t
+string_slice_reserve(string_slice_t *s, const uint64_t n)
+{
+	if (n > s->cap) {
+		string_slice_resize(s, n);
+	}
+
+	return s->cap;
+}
+
+uint64_t
+string_slice_reserve_bytes(string_slice_t *s, const uint64_t n)
+{
+	if (s->bytes_len + n > s->bytes_cap) {
+		string_slice_resize_bytes(s, s->bytes_len + n);
+	}
+
+	return s->bytes_cap;
+}
+
+uint64_t
+string_slice_bytes(const string_slice_t *s)
+{
+	return s->bytes_len;
+}
+
+int
+string_slice_set_intern(string_slice_t *s, const bool intern)
+{
+	if (!intern) {
+		slice_index_free(s->interned);
+		s->interned = NULL;
+		return 0;
+	}
+	if (s->interned != NULL) {
+		return 0;
+	}
+
+	s->interned = slice_index_new(s->allocator, true);
+	if (s->interned == NULL) {
+		return -1;
+	}
+
+	/**
+	 * the strings already stored are interned as well so later appends
+	 * can share their bytes.
+	 */
+	if (slice_index_reset(s->interned, 0) != 0) {
+		string_slice_set_intern(s, false);
+		return -1;
+	}
+	for (uint64_t i = 0; i < s->len; i++) {
+		const string_slice_entry_t e = s->items[i];
+		string_slice_match_t m = {s->bytes, s->bytes + e.off, e.len};
+		uint64_t off;
+
+		if (slice_index_lookup(s->interned, e.hash, string_slice_match, &m, &off)) {
+			continue;
+		}
+		if (slice_index_add(s->interned, e.hash, e.off, 1, string_slice_match, &m) != 0) {
+			string_slice_set_intern(s, false);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * string_slice_compact copies the strings still referenced into a new
+ * arena, in entry order, dropping the bytes of deleted and replaced
+ * strings. Neighbouring entries sharing bytes, as repeat leaves them, keep
+ * sharing them, and an interning slice shares the bytes of all equal
+ * strings. The new arena is sized up front so the copy can't fail half
+ * way. Returns -1, leaving the slice as it was, if it can't be allocated.
+ */
+static int
+string_slice_compact(string_slice_t *s)
+{
+	char *old = s->bytes;
+	uint64_t need = 0;
+	uint64_t prev_old = UINT64_MAX;
+	uint64_t prev_new = 0;
+
+	for (uint64_t i = 0; i < s->len; i++) {
+		if (s->items[i].off != prev_old) {
+			need += s->items[i].len + 1;
+		}
+		prev_old = s->items[i].off;
+	}
+
+	char *bytes = slice_alloc(s->allocator, need);
+	if (bytes == NULL) {
+		return -1;
+	}
+	s->bytes = bytes;
+	s->bytes_len = 0;
+	s->bytes_cap = need;
+	s->reallocs++;
+	if (s->interned != NULL && slice_index_reset(s->interned, 0) != 0) {
+		slice_index_invalidate(s->interned);
+	}
+
+	prev_old = UINT64_MAX;
+	for (uint64_t i = 0; i < s->len; i++) {
+		string_slice_entry_t *e = &s->items[i];
+
+		if (e->off == prev_old) {
+			e->off = prev_new;
+			continue;
+		}
+		prev_old = e->off;
+		string_slice_store(s, old + e->off, e->len, e->hash, &e->off);
+		prev_new = e->off;
+	}
+	slice_free(s->allocator, old);
+
+	/**
+	 * the hash index refers to strings by their offsets, which have all
+	 * changed.
+	 */
+	if (s->index != NULL) {
+		string_slice_index_rebuild(s);
+	}
+
+	return 0;
+}
+
+uint64_t
+string_slice_shrink_to_fit(string_slice_t *s)
+{
+	if (s->len == 0) {
+		if (s->bytes != NULL) {
+			slice_free(s->allocator, s->bytes);
+			s->bytes = NULL;
+		}
+		s->bytes_len = 0;
+		s->bytes_cap = 0;
+		if (s->interned != NULL && slice_index_reset(s->interned, 0) != 0) {
+			slice_index_invalidate(s->interned);
+		}
+	} else if (string_slice_compact(s) == 0 && s->bytes_len < s->bytes_cap) {
+		string_slice_resize_bytes(s, s->bytes_len);
+	}
+
+	if (s->len == s->cap || s->items == s->inline_items) {
+		return s->cap;
+	}
+
+	if (s->len == 0) {
+		slice_free(s->allocator, s->items);
+		s->items = NULL;
+		s->cap = 0;
+		return 0;
+	}
+
+	string_slice_resize(s, s->len);
+
+	return s->cap;
+}
+
+uint64_t
+string_slice_reallocs(const string_slice_t *s)
+{
+	return s->reallocs;
+}
+
+int
+string_slice_index_enable(string_slice_t *s)
+{
+	if (s->index == NULL) {
+		s->index = slice_index_new(s->allocator, true);
+		if (s->index == NULL) {
+			return -1;
+		}
+	}
+
+	return string_slice_index_build(s);
+}
+
+int
+string_slice_index_build(string_slice_t *s)
+{
+	slice_index_t *ix = s->index;
+
+	if (ix == NULL) {
+		return -1;
+	}
+	if (ix->valid) {
+		return 0;
+	}
+
+	return string_slice_index_rebuild(s);
+}
+
+void
+string_slice_index_disable(string_slice_t *s)
+{
+	slice_index_free(s->index);
+	s->index = NULL;
+}
+
+void
+string_slice_index_invalidate(string_slice_t *s)
+{
+	slice_index_invalidate(s->index);
+}
+
+uint64_t
+string_slice_index_bytes(const string_slice_t *s)
+{
+	return slice_index_bytes(s->index);
+}
+
+string_slice_view_t
+string_slice_as_view(const string_slice_t *s)
+{
+	string_slice_view_t v = {s->bytes, s->items, s->len};
+
+	return v;
+}
+
+string_slice_view_t
+string_slice_view(const string_slice_t *s, const uint64_t lo, const uint64_t hi)
+{
+	return string_slice_view_sub(string_slice_as_view(s), lo, hi);
+}
+
+string_slice_view_t
+string_slice_view_sub(const string_slice_view_t v, const uint64_t lo, const uint64_t hi)
+{
+	string_slice_view_t sub = {v.bytes, NULL, 0};
+
+	if (lo > hi || hi > v.len) {
+		return sub;
+	}
+	sub.items = v.items + lo;
+	sub.len = hi - lo;
+
+	return sub;
+}
+
+char*
+string_slice_view_get(const string_slice_view_t v, const uint64_t idx)
+{
+	if (idx < v.len) {
+		return string_slice_str(v.bytes, v.items[idx]);
+	}
+
+	return 0;
+}
+
+bool
+string_slice_view_contains(const string_slice_view_t v, const char *val)
+{
+	const uint64_t len = strlen(val);
+	const uint64_t hash = slice_index_hash(val, len);
+
+	for (uint64_t i = 0; i < v.len; i++) {
+		if (string_slice_entry_eq(v.bytes, v.items[i], val, len, hash)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint64_t
+string_slice_view_count(const string_slice_view_t v, const char *val, string_slice_compare_func_t compare)
+{
+	uint64_t count = 0;
+
+	if (compare != NULL) {
+		for (uint64_t i = 0; i < v.len; i++) {
+			count += compare(string_slice_str(v.bytes, v.items[i]), val, NULL);
+		}
+		return count;
+	}
+
+	const uint64_t len = strlen(val);
+	const uint64_t hash = slice_index_hash(val, len);
+
+	for (uint64_t i = 0; i < v.len; i++) {
+		count += string_slice_entry_eq(v.bytes, v.items[i], val, len, hash);
+	}
+
+	return count;
+}
+
+int
+string_slice_view_foreach(const string_slice_view_t v, string_slice_foreach_func_t ift, void *user_data)
+{
+	for (uint64_t i = 0; i < v.len; i++) {
+		ift(string_slice_str(v.bytes, v.items[i]), user_data);
+	}
+
+	return 0;
+}
+
+bool
+string_slice_view_compare(const string_slice_view_t v1, const string_slice_view_t v2, string_slice_compare_func_t compare, void *user_data)
+{
+	if (v1.len != v2.len) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < v1.len; i++) {
+		const string_slice_entry_t e1 = v1.items[i];
+		const string_slice_entry_t e2 = v2.items[i];
+		char *x = string_slice_str(v1.bytes, e1);
+		char *y = string_slice_str(v2.bytes, e2);
+
+		if (compare == NULL) {
+			if (!string_slice_entry_eq(v1.bytes, e1, y, e2.len, e2.hash)) {
+				return false;
+			}
+		} else if (!compare(x, y, user_data)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void
+string_slice_view_sort(const string_slice_view_t v, sort_compare_func_t sort_compare)
+{
+	string_slice_sort_entries(v.bytes, v.items, v.len, sort_compare, NULL);
+}
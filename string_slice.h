@@ -10,17 +10,81 @@ extern "C" {
 #include <stdint.h>
 #include <stdlib.h>
 
-typedef bool (*compare_func_t)(const char *x, const char *y, void *user_data);
-typedef void (*foreach_func_t)(const char *item, void *user_data);
-typedef int  (*sort_compare_func_t)(const void *x, const void *y);
-typedef bool (*val_equal_func_t)(const char *x, const char *y, void *user_data);
+#include "slice.h"
 
+typedef bool (*string_slice_compare_func_t)(const char *x, const char *y, void *user_data);
+typedef void (*string_slice_foreach_func_t)(const char *item, void *user_data);
+typedef bool (*string_slice_val_equal_func_t)(const char *x, const char *y, void *user_data);
+typedef bool (*string_slice_pred_func_t)(const char *item, void *user_data);
+
+/**
+ * compare_func_t, foreach_func_t and val_equal_func_t name the callback
+ * types of the first slice header included, for code written before each
+ * slice type had its own. They're only declared when SLICE_CALLBACK_ALIASES
+ * is defined, as such short names clash with the caller's own.
+ */
+#if defined(SLICE_CALLBACK_ALIASES) && !defined(__SLICE_CALLBACK_ALIASES)
+#define __SLICE_CALLBACK_ALIASES
+typedef string_slice_compare_func_t compare_func_t;
+typedef string_slice_foreach_func_t foreach_func_t;
+typedef string_slice_val_equal_func_t val_equal_func_t;
+#endif
+
+/**
+ * string_slice_entry_t locates a string in the byte arena of its slice:
+ * its len bytes start at off and are followed by a NUL. hash is the
+ * slice_index_hash of those bytes, computed once when the string is
+ * stored, so looking for a string or comparing two only reads the bytes
+ * of entries whose length and hash both match.
+ */
 typedef struct {
-    char **items;
+    uint64_t off;
+    uint64_t len;
+    uint64_t hash;
+} string_slice_entry_t;
+
+/**
+ * string_slice_t owns its strings. Their bytes are copied, one after the
+ * other, into a single growable arena, bytes, and items holds an entry
+ * per string. Appending a string is a memcpy into the arena and freeing
+ * the slice releases the arena and the entries, whatever the number of
+ * strings. Deleting or replacing a string leaves its bytes in the arena
+ * until string_slice_shrink_to_fit compacts it.
+ *
+ * The strings handed out by string_slice_get and the other accessors
+ * point into the arena, so they're invalidated by anything that adds
+ * strings to the slice.
+ *
+ * interned is NULL unless string_slice_set_intern turned interning on, in
+ * which case appending a string already in the arena reuses its bytes.
+ */
+typedef struct {
+    string_slice_entry_t *items;
     uint64_t len;
     uint64_t cap;
+    char *bytes;
+    uint64_t bytes_len;
+    uint64_t bytes_cap;
+    const slice_allocator_t *allocator;
+    slice_growth_t growth;
+    uint64_t reallocs;
+    slice_index_t *index;
+    slice_index_t *interned;
+    string_slice_entry_t inline_items[];
 } string_slice_t;
 
+/**
+ * string_slice_view_t is a window onto items owned by a slice, the
+ * equivalent of s[lo:hi] in Go. Views are cheap to pass by value and never
+ * own their items. A view is invalidated by anything that adds strings to
+ * or reallocates the slice it was taken from.
+ */
+typedef struct {
+    char *bytes;
+    string_slice_entry_t *items;
+    uint64_t len;
+} string_slice_view_t;
+
 /**
  * string_slice_new creates a pointer of type string_slice_t, sets
  * default values, and returns the pointer to the allocated memory. The user
@@ -30,24 +94,79 @@ string_slice_t*
 string_slice_new(const uint64_t cap);
 
 /**
- * string_slice_free frees the memory used by the given pointer. 
+ * string_slice_new_with_allocator creates a slice like string_slice_new but
+ * takes all of its memory from the given allocator, including the memory
+ * used when it grows. The allocator must outlive the slice. A NULL
+ * allocator uses the C library.
+ */
+string_slice_t*
+string_slice_new_with_allocator(const uint64_t cap, const slice_allocator_t *allocator);
+
+/**
+ * string_slice_new_inline creates a slice whose header and first cap
+ * entries live in a single allocation, saving an allocation and a pointer
+ * hop for slices that stay small. Growing past cap moves the entries to
+ * the heap transparently. The string bytes always live in the arena. The
+ * result is freed with string_slice_free.
+ */
+string_slice_t*
+string_slice_new_inline(const uint64_t cap);
+
+/**
+ * string_slice_new_inline_with_allocator is string_slice_new_inline taking
+ * its memory from the given allocator. Paired with a pool whose blocks fit
+ * the header and cap items, creating a slice is a single free-list pop.
+ */
+string_slice_t*
+string_slice_new_inline_with_allocator(const uint64_t cap, const slice_allocator_t *allocator);
+
+/**
+ * string_slice_free frees the memory used by the given pointer, strings
+ * included.
  */
 void
 string_slice_free(string_slice_t *s);
 
 /**
  * string_slice_get attempts to retrieve the value at the given index. If
- * the index is out of range, 0 is returned indicating an error.
+ * the index is out of range, 0 is returned indicating an error. The string
+ * belongs to the slice.
  */
 char*
 string_slice_get(string_slice_t *s, uint64_t idx);
 
 /**
- * string_slice_append attempts to append the data to the given array.
+ * string_slice_append copies the string into the slice.
  */
 void
 string_slice_append(string_slice_t *s, const char *val);
 
+/**
+ * string_slice_append_len copies the len bytes at val into the slice as a
+ * string. val needn't be NUL terminated but mustn't contain a NUL.
+ */
+void
+string_slice_append_len(string_slice_t *s, const char *val, const size_t len);
+
+/**
+ * string_slice_insert inserts a copy of val at the given index, moving the
+ * strings from there on up by one, and returns the new length, or -1 if
+ * the index is past the end or the slice couldn't grow. An index equal to
+ * the length appends.
+ */
+int64_t
+string_slice_insert(string_slice_t *s, const uint64_t idx, const char *val);
+
+/**
+ * string_slice_insert_n inserts copies of the n strings of vals at the
+ * given index, growing the entries and the arena at most once each and
+ * moving the later entries with a single memmove, and returns the new
+ * length, or -1 if the index is past the end or the slice couldn't grow.
+ * The strings must not point into the slice itself.
+ */
+int64_t
+string_slice_insert_n(string_slice_t *s, const uint64_t idx, const char *const *vals, const uint64_t n);
+
 /**
  * string_slice_reverse the contents of the array.
  */
@@ -56,23 +175,26 @@ string_slice_reverse(string_slice_t *s);
 
 /**
  * string_slice_compare takes 2 slices, compares them element by element
- * and returns true if they are the same and false if they are not.
+ * and returns true if they are the same and false if they are not. A NULL
+ * compare function compares the strings with strcmp.
  */
 bool
-string_slice_compare(const string_slice_t *s1, const string_slice_t *s2, compare_func_t compare, void *user_data);
+string_slice_compare(const string_slice_t *s1, const string_slice_t *s2, string_slice_compare_func_t compare, void *user_data);
 
 /**
- * string_slice_copy takes 2 slices. The first is copied into the second
- * with the number of elements copied being returned. The code assumes that 
- * slice 2 has been created large enough to hold the contents of slice 1. If
- * the overwrite option has been selected, the code will make sure there is 
- * enough space in slice 2 and overwrite its contents.
+ * string_slice_copy copies the strings of the first slice into the second
+ * and returns the number of strings copied. With overwrite the second
+ * slice becomes a copy of the first, growing as needed, and 0 is returned
+ * if it can't grow. Without it, like Go's copy, the strings are copied
+ * over the ones the second slice already has, as many as both slices
+ * hold, and its length stays the same.
  */
 uint64_t
 string_slice_copy(const string_slice_t *s1, string_slice_t *s2, bool overwrite);
 
 /**
- * string_slice_contains checks to see if the given value is in the slice.
+ * string_slice_contains checks to see if a string equal to the given value
+ * is in the slice.
  */
 bool
 string_slice_contains(const string_slice_t *s, char *val);
@@ -85,18 +207,57 @@ int
 string_slice_delete(string_slice_t *s, const uint64_t idx);
 
 /**
- * string_slice_replace_by_idx replaces the value at the given index with the new
- * value.
+ * string_slice_swap_remove removes the string at the given index by moving
+ * the last string into its place, which doesn't preserve the order of the
+ * strings but takes constant time. Returns the new length, or -1 if the
+ * index is out of range.
+ */
+int64_t
+string_slice_swap_remove(string_slice_t *s, const uint64_t idx);
+
+/**
+ * string_slice_delete_indices removes the strings at the n given indices
+ * in a single pass, moving each run of kept strings down once. The
+ * indices must be in ascending order, repeats being ignored. Returns the
+ * new length, or -1, leaving the slice as it was, if they aren't
+ * ascending or one is out of range.
+ */
+int64_t
+string_slice_delete_indices(string_slice_t *s, const size_t *idx, const size_t n);
+
+/**
+ * string_slice_retain keeps the strings for which pred returns true and
+ * removes the others, in a single pass that keeps the order of the strings
+ * kept, and returns the new length. pred is called once per string, in
+ * order. The bytes of removed strings stay in the arena until
+ * string_slice_shrink_to_fit.
+ */
+uint64_t
+string_slice_retain(string_slice_t *s, string_slice_pred_func_t pred, void *user_data);
+
+/**
+ * string_slice_remove_value removes every string equal to val in a single
+ * pass that keeps the order of the others, and returns the new length.
+ * Only strings whose cached length and hash match val are compared.
+ */
+uint64_t
+string_slice_remove_value(string_slice_t *s, const char *val);
+
+/**
+ * string_slice_replace_by_idx replaces the value at the given index with a
+ * copy of the new value.
  */
 int
 string_slice_replace_by_idx(string_slice_t *s, const uint64_t idx, const char *val);
 
 /**
  * string_slice_replace_by_val replaces occurrences of the value with the
- * new value, the number of times given. 
+ * new value, the number of times given. A NULL compare function matches
+ * strings equal to old_val according to strcmp. The new value is copied
+ * into the slice once and shared by every replaced string.
  */
 int
-string_slice_replace_by_val(string_slice_t *s, const char *old_val, const char *new_val, uint64_t times, compare_func_t compare);
+string_slice_replace_by_val(string_slice_t *s, const char *old_val, const char *new_val, uint64_t times, string_slice_compare_func_t compare);
 
 /**
  * uint_slice returns the first element of the slice.
@@ -116,11 +277,11 @@ string_slice_last(string_slice_t *s);
  * user_data argument.
  */
 int
-string_slice_foreach(string_slice_t *s, foreach_func_t ift, void *user_data);
+string_slice_foreach(string_slice_t *s, string_slice_foreach_func_t ift, void *user_data);
 
 /**
  * string_slice_sort uses that Quick Sort algorithm to sort the contents
- * of the slice.
+ * of the slice. A NULL sort_compare sorts the strings in strcmp order.
  */
 void
 string_slice_sort(string_slice_t *s, sort_compare_func_t sort_compare);
@@ -128,18 +289,21 @@ string_slice_sort(string_slice_t *s, sort_compare_func_t sort_compare);
 /**
  * string_slice_repeat takes a value and repeats that value in the slice
  * for the number of times given and returns the new length of the slice.
+ * The value is copied into the slice once and shared by the repeats.
  */
 uint64_t
 string_slice_repeat(string_slice_t *s, const char *val, const uint64_t times);
 
 /**
- * string_slice_count counts the occurrences of the given value.
+ * string_slice_count counts the occurrences of the given value. A NULL
+ * compare function counts strings equal to val according to strcmp, by a
+ * hash index lookup if the slice has one.
  */
 uint64_t
-string_slice_count(string_slice_t *s, const char *val, compare_func_t compare);
+string_slice_count(string_slice_t *s, const char *val, string_slice_compare_func_t compare);
 
 /**
- * string_slice_grow grows the slice by the given size.
+ * string_slice_grow grows the slice by the given number of strings.
  */
 uint64_t
 string_slice_grow(string_slice_t *s, const uint64_t size);
@@ -150,6 +314,170 @@ string_slice_grow(string_slice_t *s, const uint64_t size);
 uint64_t
 string_slice_concat(string_slice_t *s1, const string_slice_t *s2);
 
+/**
+ * string_slice_set_growth sets the policy used to pick the new capacity
+ * when an append or concat runs out of room. Slices start out with
+ * SLICE_GROWTH_DOUBLE.
+ */
+void
+string_slice_set_growth(string_slice_t *s, const slice_growth_t growth);
+
+/**
+ * string_slice_reserve makes sure the slice can hold at least n strings
+ * without reallocating its entries and returns the resulting capacity.
+ */
+uint64_t
+string_slice_reserve(string_slice_t *s, const uint64_t n);
+
+/**
+ * string_slice_reserve_bytes makes sure the arena can take at least n
+ * more bytes of strings, counting a NUL for each, without reallocating
+ * and returns the number of bytes it can hold.
+ */
+uint64_t
+string_slice_reserve_bytes(string_slice_t *s, const uint64_t n);
+
+/**
+ * string_slice_bytes returns the number of arena bytes in use, the NULs
+ * and the bytes of deleted or replaced strings included.
+ */
+uint64_t
+string_slice_bytes(const string_slice_t *s);
+
+/**
+ * string_slice_set_intern turns interning on or off. While it's on, a
+ * string equal to one already in the arena is stored by reusing its
+ * bytes, which saves memory for slices holding many duplicates at the
+ * cost of a hash lookup per append. Returns -1 if it can't be turned on.
+ */
+int
+string_slice_set_intern(string_slice_t *s, const bool intern);
+
+/**
+ * string_slice_shrink_to_fit gives unused capacity back to the allocator
+ * and returns the new capacity. The arena is compacted first, dropping
+ * the bytes of deleted and replaced strings. Entries stored inline with
+ * the header are left where they are.
+ */
+uint64_t
+string_slice_shrink_to_fit(string_slice_t *s);
+
+/**
+ * string_slice_reallocs returns the number of times the slice's entries or
+ * arena have been reallocated since it was created.
+ */
+uint64_t
+string_slice_reallocs(const string_slice_t *s);
+
+/**
+ * string_slice_index_enable attaches a hash index to the slice and builds
+ * it, making contains and count constant time lookups. The calls that
+ * write strings keep it up to date: appends and inserts add theirs,
+ * deletes, removes and replaces take out the strings they drop, and
+ * sorting and reversing don't touch it. Queries never write to the index,
+ * so an indexed slice can be read from several threads at once as long as
+ * none of them writes to it. Returns -1 if the index can't be allocated
+ * or built.
+ */
+int
+string_slice_index_enable(string_slice_t *s);
+
+/**
+ * string_slice_index_build brings a stale hash index up to date with the
+ * strings, after writes through a view or an index that couldn't grow.
+ * Returns -1 if the slice has no index or it can't be built, in which case
+ * it stays stale.
+ */
+int
+string_slice_index_build(string_slice_t *s);
+
+/**
+ * string_slice_index_disable frees the slice's hash index, if it has one.
+ */
+void
+string_slice_index_disable(string_slice_t *s);
+
+/**
+ * string_slice_index_invalidate marks the hash index stale, for strings
+ * changed through a view or in place. Queries compare strings until
+ * string_slice_index_build.
+ */
+void
+string_slice_index_invalidate(string_slice_t *s);
+
+/**
+ * string_slice_index_bytes returns the memory used by the slice's hash
+ * index, 0 if it has none. The index keeps a 16 byte entry and the arena
+ * offset of a matching string for each distinct string, in a table kept
+ * at most 3/4 full.
+ */
+uint64_t
+string_slice_index_bytes(const string_slice_t *s);
+
+/**
+ * string_slice_as_view returns a view over all items of the slice.
+ */
+string_slice_view_t
+string_slice_as_view(const string_slice_t *s);
+
+/**
+ * string_slice_view returns a view over items lo up to, but not including,
+ * hi without copying them. An empty view is returned if the bounds are
+ * out of range.
+ */
+string_slice_view_t
+string_slice_view(const string_slice_t *s, const uint64_t lo, const uint64_t hi);
+
+/**
+ * string_slice_view_sub narrows a view the same way string_slice_view does a
+ * slice. The bounds are relative to the view.
+ */
+string_slice_view_t
+string_slice_view_sub(const string_slice_view_t v, const uint64_t lo, const uint64_t hi);
+
+/**
+ * string_slice_view_get returns the item at the given index of the view, or
+ * 0 if the index is out of range.
+ */
+char*
+string_slice_view_get(const string_slice_view_t v, const uint64_t idx);
+
+/**
+ * string_slice_view_contains checks to see if a string equal to the given
+ * value is in the view.
+ */
+bool
+string_slice_view_contains(const string_slice_view_t v, const char *val);
+
+/**
+ * string_slice_view_count counts the occurrences of the given value in the
+ * view.
+ */
+uint64_t
+string_slice_view_count(const string_slice_view_t v, const char *val, string_slice_compare_func_t compare);
+
+/**
+ * string_slice_view_foreach runs the user provided function on each item of
+ * the view.
+ */
+int
+string_slice_view_foreach(const string_slice_view_t v, string_slice_foreach_func_t ift, void *user_data);
+
+/**
+ * string_slice_view_compare compares 2 views element by element and returns
+ * true if they are the same.
+ */
+bool
+string_slice_view_compare(const string_slice_view_t v1, const string_slice_view_t v2, string_slice_compare_func_t compare, void *user_data);
+
+/**
+ * string_slice_view_sort sorts the items of the view in place, leaving the
+ * rest of the underlying slice untouched. A NULL sort_compare sorts the
+ * strings in strcmp order.
+ */
+void
+string_slice_view_sort(const string_slice_view_t v, sort_compare_func_t sort_compare);
+
 #endif /** end __STRING_H */
 #ifdef __cplusplus
 }
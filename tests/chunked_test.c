@@ -0,0 +1,174 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../int_slice.h"
+#include "test.h"
+
+static uint64_t blocks;
+static uint64_t block_items;
+static uint64_t block_bad;
+
+/**
+ * count_block checks that the items of a block carry on from the ones
+ * before it, the test storing each item's index as its value.
+ */
+static void
+count_block(const int *items, const uint64_t n, void *user_data)
+{
+	const uint64_t chunk = *(const uint64_t *)user_data;
+
+	blocks++;
+	block_bad += n == 0 || n > chunk;
+	for (uint64_t i = 0; i < n; i++) {
+		block_bad += items[i] != (int)(block_items + i);
+	}
+	block_items += n;
+}
+
+/**
+ * check_items checks that the n items of c are 0 to n - 1, through get,
+ * at, foreach_block and to_slice.
+ */
+static void
+check_items(const int_slice_chunked_t *c, const uint64_t n)
+{
+	uint64_t chunk = int_slice_chunked_chunk_len(c);
+	uint64_t bad = 0;
+
+	CHECK(int_slice_chunked_len(c) == n);
+	CHECK(int_slice_chunked_cap(c) >= n);
+	CHECK(int_slice_chunked_cap(c) % chunk == 0);
+	for (uint64_t i = 0; i < n; i++) {
+		bad += int_slice_chunked_get(c, i) != (int)i;
+		bad += *int_slice_chunked_at(c, i) != (int)i;
+	}
+	CHECK(bad == 0);
+	CHECK(int_slice_chunked_get(c, n) == 0);
+	CHECK(int_slice_chunked_at(c, n) == NULL);
+
+	blocks = block_items = block_bad = 0;
+	CHECK(int_slice_chunked_foreach_block(c, count_block, &chunk) == 0);
+	CHECK(blocks == (n + chunk - 1) / chunk);
+	CHECK(block_items == n);
+	CHECK(block_bad == 0);
+
+	int_slice_t *s = int_slice_chunked_to_slice(c);
+	CHECK(s != NULL);
+	if (s == NULL) {
+		return;
+	}
+	CHECK(int_slice_len(s) == n);
+	for (uint64_t i = 0; i < int_slice_len(s); i++) {
+		bad += int_slice_get(s, i) != (int)i;
+	}
+	CHECK(bad == 0);
+	int_slice_free(s);
+}
+
+/**
+ * append_range appends the values from to to - 1 with a single append_n.
+ */
+static void
+append_range(int_slice_chunked_t *c, const uint64_t from, const uint64_t to)
+{
+	int *buf = malloc(sizeof(int) * (to - from + 1));
+
+	CHECK(buf != NULL);
+	if (buf == NULL) {
+		return;
+	}
+	for (uint64_t i = from; i < to; i++) {
+		buf[i - from] = (int)i;
+	}
+	CHECK(int_slice_chunked_append_n(c, buf, to - from) == 0);
+	free(buf);
+}
+
+int
+main(void)
+{
+	int_slice_chunked_t *c = int_slice_chunked_new(0);
+	int v;
+
+	CHECK(c != NULL);
+	if (c == NULL) {
+		return test_report("chunked_test");
+	}
+	const uint64_t chunk = int_slice_chunked_chunk_len(c);
+	CHECK(chunk > 1 && (chunk & (chunk - 1)) == 0);
+	CHECK(int_slice_chunked_cap(c) == 0);
+	CHECK(int_slice_chunked_pop_back(c, &v) == -1);
+	check_items(c, 0);
+
+	/**
+	 * single appends stop just short of the first chunk's end, so the
+	 * runs that follow start inside a chunk and cross into the next.
+	 */
+	for (uint64_t i = 0; i < chunk - 3; i++) {
+		CHECK(int_slice_chunked_append(c, (int)i) == 0);
+	}
+	int *first = int_slice_chunked_at(c, 0);
+	check_items(c, chunk - 3);
+
+	append_range(c, chunk - 3, chunk + 7);
+	check_items(c, chunk + 7);
+
+	/**
+	 * a run longer than two chunks fills one, spans another whole and
+	 * ends in a third.
+	 */
+	append_range(c, chunk + 7, 4 * chunk + 1);
+	check_items(c, 4 * chunk + 1);
+
+	append_range(c, 4 * chunk + 1, 5 * chunk);
+	check_items(c, 5 * chunk);
+	CHECK(int_slice_chunked_cap(c) == 5 * chunk);
+	CHECK(int_slice_chunked_append_n(c, NULL, 0) == 0);
+	check_items(c, 5 * chunk);
+
+	/**
+	 * the items never move, whatever was appended after them.
+	 */
+	CHECK(int_slice_chunked_at(c, 0) == first);
+
+	/**
+	 * popping back across a chunk boundary keeps the chunk, which the
+	 * next appends fill again.
+	 */
+	for (uint64_t i = 5 * chunk; i > 4 * chunk - 2; i--) {
+		CHECK(int_slice_chunked_pop_back(c, &v) == 0 && v == (int)(i - 1));
+	}
+	CHECK(int_slice_chunked_cap(c) == 5 * chunk);
+	check_items(c, 4 * chunk - 2);
+	append_range(c, 4 * chunk - 2, 4 * chunk + 3);
+	check_items(c, 4 * chunk + 3);
+
+	CHECK(int_slice_chunked_set(c, 7, -7) == 0);
+	CHECK(int_slice_chunked_get(c, 7) == -7);
+	CHECK(int_slice_chunked_set(c, 7, 7) == 0);
+	CHECK(int_slice_chunked_set(c, 4 * chunk + 3, 0) == -1);
+
+	int_slice_chunked_clear(c);
+	check_items(c, 0);
+	CHECK(int_slice_chunked_cap(c) == 5 * chunk);
+	append_range(c, 0, chunk + 1);
+	check_items(c, chunk + 1);
+	CHECK(int_slice_chunked_at(c, 0) == first);
+	int_slice_chunked_free(c);
+
+	/**
+	 * a capacity given up front is allocated in whole chunks.
+	 */
+	c = int_slice_chunked_new(chunk + 1);
+	CHECK(c != NULL);
+	if (c != NULL) {
+		CHECK(int_slice_chunked_cap(c) == 2 * chunk);
+		check_items(c, 0);
+		int_slice_chunked_free(c);
+	}
+
+	return test_report("chunked_test");
+}
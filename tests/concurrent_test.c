@@ -0,0 +1,217 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../slice_allocator.h"
+#include "../uint64_slice.h"
+#include "test.h"
+
+#define PRODUCERS 16
+#define PER_PRODUCER 20000
+#define BATCH 7
+#define TOTAL ((uint64_t)PRODUCERS * PER_PRODUCER)
+
+static uint64_slice_concurrent_t *shared;
+
+/**
+ * produce appends producer t's values, t * PER_PRODUCER up to the next
+ * producer's first, in order. Odd producers append in batches of BATCH
+ * so append and append_n race against each other. It returns the number
+ * of failed appends.
+ */
+static void*
+produce(void *arg)
+{
+	const uint64_t t = (uint64_t)(uintptr_t)arg;
+	uint64_t buf[BATCH];
+	uintptr_t bad = 0;
+
+	for (uint64_t i = 0; i < PER_PRODUCER;) {
+		if (t % 2 == 1 && i + BATCH <= PER_PRODUCER) {
+			for (uint64_t j = 0; j < BATCH; j++) {
+				buf[j] = t * PER_PRODUCER + i + j;
+			}
+			bad += uint64_slice_concurrent_append_n(shared, buf, BATCH) != 0;
+			i += BATCH;
+		} else {
+			bad += uint64_slice_concurrent_append(shared, t * PER_PRODUCER + i) != 0;
+			i++;
+		}
+	}
+
+	return (void*)bad;
+}
+
+/**
+ * check_items checks that every appended value is in the slice exactly
+ * once, that each producer's values kept their order and that the frozen
+ * slice matches the concurrent one.
+ */
+static void
+check_items(const uint64_slice_t *s)
+{
+	bool *seen = calloc(TOTAL, sizeof(bool));
+	uint64_t next[PRODUCERS] = {0};
+	const uint64_t *items = uint64_slice_data(s);
+	uint64_t dups = 0, strays = 0, reordered = 0, mismatched = 0;
+
+	CHECK(seen != NULL);
+	if (seen == NULL) {
+		return;
+	}
+
+	for (uint64_t i = 0; i < uint64_slice_len(s); i++) {
+		const uint64_t v = items[i];
+
+		if (v >= TOTAL) {
+			strays++;
+			continue;
+		}
+		dups += seen[v];
+		seen[v] = true;
+
+		const uint64_t t = v / PER_PRODUCER;
+		reordered += v % PER_PRODUCER < next[t];
+		next[t] = v % PER_PRODUCER + 1;
+
+		mismatched += uint64_slice_concurrent_get(shared, i) != v;
+	}
+
+	uint64_t missing = 0;
+	for (uint64_t v = 0; v < TOTAL; v++) {
+		missing += !seen[v];
+	}
+	free(seen);
+
+	CHECK(dups == 0);
+	CHECK(strays == 0);
+	CHECK(missing == 0);
+	CHECK(reordered == 0);
+	CHECK(mismatched == 0);
+}
+
+/**
+ * the flaky allocator fails its next allocation when fail_next is set and
+ * fills the memory it does hand out with garbage, so a segment that isn't
+ * zeroed shows in the slots nobody wrote.
+ */
+static bool fail_next;
+
+static void*
+flaky_alloc(void *ctx, size_t size)
+{
+	(void)ctx;
+	if (fail_next) {
+		fail_next = false;
+		return NULL;
+	}
+
+	void *p = malloc(size);
+	if (p != NULL) {
+		memset(p, 0xa5, size);
+	}
+
+	return p;
+}
+
+static void*
+flaky_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+	(void)ctx;
+	(void)old_size;
+
+	return realloc(ptr, new_size);
+}
+
+static void
+flaky_free(void *ctx, void *ptr)
+{
+	(void)ctx;
+	free(ptr);
+}
+
+static const slice_allocator_t flaky = {
+	flaky_alloc, flaky_realloc, flaky_free, NULL
+};
+
+/**
+ * check_failed_slot makes the append that opens the second segment fail.
+ * The next append allocates the segment, and the failed append's slot has
+ * to read as 0 in get and in the frozen slice.
+ */
+static void
+check_failed_slot(void)
+{
+	const uint64_t first = (uint64_t)1 << SLICE_CONCURRENT_MIN_SHIFT;
+	uint64_slice_concurrent_t *c = uint64_slice_concurrent_new_with_allocator(first, &flaky);
+	CHECK(c != NULL);
+	if (c == NULL) {
+		return;
+	}
+
+	uint64_t i = 0;
+	while (i < first) {
+		CHECK(uint64_slice_concurrent_append(c, ++i) == 0);
+	}
+	fail_next = true;
+	CHECK(uint64_slice_concurrent_append(c, ++i) == -1);
+	CHECK(uint64_slice_concurrent_append(c, ++i) == 0);
+
+	CHECK(uint64_slice_concurrent_len(c) == first + 2);
+	CHECK(uint64_slice_concurrent_get(c, first) == 0);
+	CHECK(uint64_slice_concurrent_get(c, first + 1) == first + 2);
+
+	uint64_slice_t *s = uint64_slice_concurrent_freeze(c);
+	CHECK(s != NULL);
+	if (s != NULL) {
+		CHECK(uint64_slice_get(s, first) == 0);
+		CHECK(uint64_slice_get(s, first + 1) == first + 2);
+		uint64_slice_free(s);
+	}
+	uint64_slice_concurrent_free(c);
+}
+
+int
+main(void)
+{
+	pthread_t threads[PRODUCERS];
+
+	/**
+	 * a small first segment makes the producers race on allocating the
+	 * later ones.
+	 */
+	shared = uint64_slice_concurrent_new(16);
+	CHECK(shared != NULL);
+	if (shared == NULL) {
+		return 1;
+	}
+
+	for (uint64_t t = 0; t < PRODUCERS; t++) {
+		CHECK(pthread_create(&threads[t], NULL, produce, (void*)(uintptr_t)t) == 0);
+	}
+	for (uint64_t t = 0; t < PRODUCERS; t++) {
+		void *bad;
+		CHECK(pthread_join(threads[t], &bad) == 0);
+		CHECK((uintptr_t)bad == 0);
+	}
+
+	CHECK(uint64_slice_concurrent_len(shared) == TOTAL);
+	CHECK(uint64_slice_concurrent_get(shared, TOTAL) == 0);
+
+	uint64_slice_t *s = uint64_slice_concurrent_freeze(shared);
+	CHECK(s != NULL);
+	if (s != NULL) {
+		CHECK(uint64_slice_len(s) == TOTAL);
+		check_items(s);
+		uint64_slice_free(s);
+	}
+	uint64_slice_concurrent_free(shared);
+
+	check_failed_slot();
+
+	return test_report("concurrent_test");
+}
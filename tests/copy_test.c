@@ -0,0 +1,136 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../int_slice.h"
+#include "../string_slice.h"
+#include "test.h"
+
+static int_slice_t*
+ints_of(const int *vals, const uint64_t n)
+{
+	int_slice_t *s = int_slice_new(0);
+
+	for (uint64_t i = 0; i < n; i++) {
+		int_slice_append(s, vals[i]);
+	}
+
+	return s;
+}
+
+static string_slice_t*
+strings_of(const char *const *vals, const uint64_t n)
+{
+	string_slice_t *s = string_slice_new(0);
+
+	for (uint64_t i = 0; i < n; i++) {
+		string_slice_append(s, vals[i]);
+	}
+
+	return s;
+}
+
+static void
+test_int_copy(void)
+{
+	const int src[] = {1, 2, 3, 4};
+	const int dst[] = {9, 9};
+	int_slice_t *s1 = ints_of(src, 4);
+	int_slice_t *s2;
+
+	/**
+	 * overwrite grows the destination and replaces its items.
+	 */
+	s2 = ints_of(dst, 2);
+	CHECK(int_slice_copy(s1, s2, true) == 4);
+	CHECK(int_slice_len(s2) == 4);
+	CHECK(int_slice_compare(s1, s2, NULL, NULL));
+	int_slice_free(s2);
+
+	/**
+	 * without it only the items both slices hold are copied.
+	 */
+	s2 = ints_of(dst, 2);
+	CHECK(int_slice_copy(s1, s2, false) == 2);
+	CHECK(int_slice_len(s2) == 2);
+	CHECK(int_slice_get(s2, 0) == 1 && int_slice_get(s2, 1) == 2);
+	int_slice_free(s2);
+
+	s2 = ints_of(src, 4);
+	int_slice_t *short_src = ints_of(dst, 2);
+	CHECK(int_slice_copy(short_src, s2, false) == 2);
+	CHECK(int_slice_len(s2) == 4);
+	CHECK(int_slice_get(s2, 0) == 9 && int_slice_get(s2, 1) == 9);
+	CHECK(int_slice_get(s2, 2) == 3 && int_slice_get(s2, 3) == 4);
+
+	/**
+	 * overwrite shrinks the destination to the source's length.
+	 */
+	CHECK(int_slice_copy(short_src, s2, true) == 2);
+	CHECK(int_slice_len(s2) == 2);
+	int_slice_free(short_src);
+	int_slice_free(s2);
+
+	s2 = int_slice_new(0);
+	CHECK(int_slice_copy(s1, s2, false) == 0);
+	CHECK(int_slice_len(s2) == 0);
+	int_slice_free(s2);
+
+	CHECK(int_slice_copy(s1, s1, true) == 4);
+	CHECK(int_slice_len(s1) == 4);
+	int_slice_free(s1);
+}
+
+static void
+test_string_copy(void)
+{
+	const char *const src[] = {"a", "bb", "ccc", "dddd"};
+	const char *const dst[] = {"x", "y"};
+	string_slice_t *s1 = strings_of(src, 4);
+	string_slice_t *s2;
+
+	s2 = strings_of(dst, 2);
+	CHECK(string_slice_copy(s1, s2, true) == 4);
+	CHECK(s2->len == 4);
+	CHECK(string_slice_compare(s1, s2, NULL, NULL));
+	string_slice_free(s2);
+
+	s2 = strings_of(dst, 2);
+	CHECK(string_slice_copy(s1, s2, false) == 2);
+	CHECK(s2->len == 2);
+	CHECK(strcmp(string_slice_get(s2, 0), "a") == 0);
+	CHECK(strcmp(string_slice_get(s2, 1), "bb") == 0);
+	string_slice_free(s2);
+
+	s2 = strings_of(src, 4);
+	string_slice_t *short_src = strings_of(dst, 2);
+	CHECK(string_slice_index_enable(s2) == 0);
+	CHECK(string_slice_copy(short_src, s2, false) == 2);
+	CHECK(s2->len == 4);
+	CHECK(strcmp(string_slice_get(s2, 0), "x") == 0);
+	CHECK(strcmp(string_slice_get(s2, 2), "ccc") == 0);
+	CHECK(string_slice_count(s2, "a", NULL) == 0);
+	CHECK(string_slice_index_build(s2) == 0);
+	CHECK(string_slice_count(s2, "x", NULL) == 1);
+	CHECK(!string_slice_contains(s2, "a"));
+
+	CHECK(string_slice_copy(short_src, s2, true) == 2);
+	CHECK(s2->len == 2);
+	string_slice_free(short_src);
+	string_slice_free(s2);
+
+	CHECK(string_slice_copy(s1, s1, false) == 4);
+	CHECK(s1->len == 4);
+	string_slice_free(s1);
+}
+
+int
+main(void)
+{
+	test_int_copy();
+	test_string_copy();
+
+	return test_report("copy_test");
+}
@@ -0,0 +1,277 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../int_slice.h"
+#include "test.h"
+
+#define MODEL_CAP 4096
+#define OPS 20000
+
+static int sum;
+
+static void
+add_item(const int item, void *user_data)
+{
+	(void)user_data;
+	sum += item;
+}
+
+/**
+ * check_items compares the deque, through get, front, back, segments and
+ * foreach, with the n items of want.
+ */
+static void
+check_items(const int_slice_deque_t *d, const int *want, const uint64_t n)
+{
+	int_slice_view_t first, second;
+	uint64_t bad = 0;
+	int want_sum = 0;
+
+	CHECK(int_slice_deque_len(d) == n);
+	CHECK(int_slice_deque_len(d) <= int_slice_deque_cap(d));
+	for (uint64_t i = 0; i < n; i++) {
+		bad += int_slice_deque_get(d, i) != want[i];
+		want_sum += want[i];
+	}
+	CHECK(bad == 0);
+	CHECK(int_slice_deque_get(d, n) == 0);
+	CHECK(int_slice_deque_front(d) == (n > 0 ? want[0] : 0));
+	CHECK(int_slice_deque_back(d) == (n > 0 ? want[n - 1] : 0));
+
+	int_slice_deque_segments(d, &first, &second);
+	CHECK(first.len + second.len == n);
+	CHECK(second.len == 0 || first.len > 0);
+	for (uint64_t i = 0; i < first.len && i < n; i++) {
+		bad += first.items[i] != want[i];
+	}
+	for (uint64_t i = 0; i < second.len && first.len + i < n; i++) {
+		bad += second.items[i] != want[first.len + i];
+	}
+	CHECK(bad == 0);
+
+	sum = 0;
+	CHECK(int_slice_deque_foreach(d, add_item, NULL) == 0);
+	CHECK(sum == want_sum);
+}
+
+/**
+ * test_wrap pushes and pops at both ends of a deque of 8 slots so the
+ * items wrap around the end of the buffer, in both directions, without
+ * the deque growing.
+ */
+static void
+test_wrap(void)
+{
+	int_slice_deque_t *d = int_slice_deque_new(8);
+	int_slice_view_t first, second;
+	int v;
+
+	CHECK(d != NULL);
+	CHECK(int_slice_deque_cap(d) == 8);
+	CHECK(int_slice_deque_pop_front(d, &v) == -1);
+	CHECK(int_slice_deque_pop_back(d, &v) == -1);
+	check_items(d, NULL, 0);
+
+	/**
+	 * a push to the front of an empty deque goes to the last slot.
+	 */
+	CHECK(int_slice_deque_push_front(d, 2) == 0);
+	CHECK(int_slice_deque_push_front(d, 1) == 0);
+	CHECK(int_slice_deque_push_back(d, 3) == 0);
+	int_slice_deque_segments(d, &first, &second);
+	CHECK(first.len == 2 && second.len == 1);
+	check_items(d, (const int[]){1, 2, 3}, 3);
+
+	CHECK(int_slice_deque_pop_front(d, &v) == 0 && v == 1);
+	CHECK(int_slice_deque_pop_front(d, &v) == 0 && v == 2);
+	int_slice_deque_segments(d, &first, &second);
+	CHECK(first.len == 1 && second.len == 0);
+	check_items(d, (const int[]){3}, 1);
+
+	/**
+	 * the back then fills the buffer and pop_back walks back across the
+	 * wrap.
+	 */
+	for (int i = 4; i <= 10; i++) {
+		CHECK(int_slice_deque_push_back(d, i) == 0);
+	}
+	CHECK(int_slice_deque_cap(d) == 8);
+	check_items(d, (const int[]){3, 4, 5, 6, 7, 8, 9, 10}, 8);
+	for (int i = 10; i >= 5; i--) {
+		CHECK(int_slice_deque_pop_back(d, &v) == 0 && v == i);
+	}
+	check_items(d, (const int[]){3, 4}, 2);
+	CHECK(int_slice_deque_pop_back(d, NULL) == 0);
+	CHECK(int_slice_deque_pop_front(d, NULL) == 0);
+	CHECK(int_slice_deque_pop_back(d, &v) == -1);
+	check_items(d, NULL, 0);
+
+	/**
+	 * growing a wrapped deque keeps the items in order.
+	 */
+	for (int i = 0; i < 5; i++) {
+		CHECK(int_slice_deque_push_back(d, i) == 0);
+		CHECK(int_slice_deque_push_front(d, -i - 1) == 0);
+	}
+	CHECK(int_slice_deque_cap(d) == 16);
+	check_items(d, (const int[]){-5, -4, -3, -2, -1, 0, 1, 2, 3, 4}, 10);
+
+	int_slice_deque_clear(d);
+	check_items(d, NULL, 0);
+	int_slice_deque_free(d);
+}
+
+/**
+ * test_wrap_n moves runs of items in and out across the end of the buffer.
+ */
+static void
+test_wrap_n(void)
+{
+	int_slice_deque_t *d = int_slice_deque_new(8);
+	int_slice_view_t first, second;
+	int buf[16];
+
+	for (int i = 0; i < 6; i++) {
+		CHECK(int_slice_deque_push_back(d, i) == 0);
+	}
+	CHECK(int_slice_deque_pop_front_n(d, buf, 6) == 6);
+	CHECK(buf[0] == 0 && buf[5] == 5);
+	CHECK(int_slice_deque_push_back_n(d, (const int[]){10, 11, 12, 13, 14}, 5) == 0);
+	CHECK(int_slice_deque_cap(d) == 8);
+	int_slice_deque_segments(d, &first, &second);
+	CHECK(first.len == 2 && second.len == 3);
+	CHECK(first.items[0] == 10 && second.items[0] == 12);
+	check_items(d, (const int[]){10, 11, 12, 13, 14}, 5);
+
+	/**
+	 * the run that doesn't fit grows the deque while it's wrapped, and
+	 * the items stay wrapped in the larger buffer.
+	 */
+	CHECK(int_slice_deque_push_back_n(d, (const int[]){15, 16, 17, 18, 19, 20, 21}, 7) == 0);
+	CHECK(int_slice_deque_cap(d) == 16);
+	int_slice_deque_segments(d, &first, &second);
+	CHECK(first.len == 10 && second.len == 2);
+	check_items(d, (const int[]){10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21}, 12);
+
+	CHECK(int_slice_deque_pop_front_n(d, buf, 11) == 11);
+	CHECK(buf[0] == 10 && buf[9] == 19 && buf[10] == 20);
+	check_items(d, (const int[]){21}, 1);
+
+	CHECK(int_slice_deque_push_back_n(d, buf, 0) == 0);
+	CHECK(int_slice_deque_pop_front_n(d, buf, 0) == 0);
+	CHECK(int_slice_deque_pop_front_n(d, buf, 16) == 1);
+	CHECK(buf[0] == 21);
+	CHECK(int_slice_deque_pop_front_n(d, buf, 16) == 0);
+	check_items(d, NULL, 0);
+	int_slice_deque_free(d);
+}
+
+/**
+ * test_model runs a random mix of every push and pop against a plain
+ * array holding the same items, starting from an empty deque with no
+ * buffer.
+ */
+static void
+test_model(void)
+{
+	static int model[2 * MODEL_CAP];
+	uint64_t lo = MODEL_CAP, hi = MODEL_CAP;
+	uint64_t rand_state = 0x9e3779b97f4a7c15ULL;
+	int_slice_deque_t *d = int_slice_deque_new(0);
+	int buf[64];
+	int next = 1;
+	int v;
+
+	CHECK(int_slice_deque_cap(d) == 0);
+
+	for (int op = 0; op < OPS; op++) {
+		rand_state ^= rand_state << 13;
+		rand_state ^= rand_state >> 7;
+		rand_state ^= rand_state << 17;
+
+		const uint64_t r = rand_state >> 8;
+		const uint64_t n = r % 64;
+		const bool full = hi - lo + 64 > MODEL_CAP;
+
+		switch (rand_state % 6) {
+		case 0:
+			if (full) {
+				break;
+			}
+			CHECK(int_slice_deque_push_back(d, next) == 0);
+			model[hi++] = next++;
+			break;
+		case 1:
+			if (full) {
+				break;
+			}
+			CHECK(int_slice_deque_push_front(d, next) == 0);
+			model[--lo] = next++;
+			break;
+		case 2:
+			CHECK(int_slice_deque_pop_front(d, &v) == (lo == hi ? -1 : 0));
+			if (lo < hi) {
+				CHECK(v == model[lo++]);
+			}
+			break;
+		case 3:
+			CHECK(int_slice_deque_pop_back(d, &v) == (lo == hi ? -1 : 0));
+			if (lo < hi) {
+				CHECK(v == model[--hi]);
+			}
+			break;
+		case 4:
+			if (full) {
+				break;
+			}
+			for (uint64_t i = 0; i < n; i++) {
+				buf[i] = next++;
+				model[hi++] = buf[i];
+			}
+			CHECK(int_slice_deque_push_back_n(d, buf, n) == 0);
+			break;
+		default: {
+			const uint64_t want = n < hi - lo ? n : hi - lo;
+			uint64_t bad = 0;
+
+			CHECK(int_slice_deque_pop_front_n(d, buf, n) == want);
+			for (uint64_t i = 0; i < want; i++) {
+				bad += buf[i] != model[lo++];
+			}
+			CHECK(bad == 0);
+			break;
+		}
+		}
+
+		/**
+		 * the model's items are moved back to the middle when they come
+		 * close to either end of it.
+		 */
+		if (lo < 64 || hi + 64 > 2 * MODEL_CAP) {
+			const uint64_t len = hi - lo;
+			const uint64_t mid = MODEL_CAP - len / 2;
+
+			memmove(model + mid, model + lo, sizeof(int) * len);
+			lo = mid;
+			hi = mid + len;
+		}
+		if (op % 97 == 0) {
+			check_items(d, model + lo, hi - lo);
+		}
+	}
+	check_items(d, model + lo, hi - lo);
+	int_slice_deque_free(d);
+}
+
+int
+main(void)
+{
+	test_wrap();
+	test_wrap_n();
+	test_model();
+
+	return test_report("deque_test");
+}
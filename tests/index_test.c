@@ -0,0 +1,263 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../int_slice.h"
+#include "../slice_index.h"
+#include "../string_slice.h"
+#include "test.h"
+
+#define DISTINCT 1000
+#define REPEATS 100
+#define READERS 4
+
+/**
+ * the slices hold REPEATS runs of 0 to DISTINCT - 1, then lose their
+ * first item, so 0 occurs once less than the other values and first
+ * appears at DISTINCT - 1.
+ */
+static int_slice_t *ints;
+static string_slice_t *strings;
+
+static uint64_t
+want_count(int v)
+{
+	return v == 0 ? REPEATS - 1 : REPEATS;
+}
+
+static int64_t
+want_index(int v)
+{
+	return v == 0 ? DISTINCT - 1 : v - 1;
+}
+
+/**
+ * read_all runs every query on both slices and returns the number of
+ * wrong answers. It only reads, so any number of threads can run it.
+ */
+static void*
+read_all(void *arg)
+{
+	uintptr_t bad = 0;
+	char key[16];
+	(void)arg;
+
+	for (int v = 0; v < DISTINCT; v++) {
+		bad += !int_slice_contains(ints, v);
+		bad += int_slice_count(ints, v, NULL) != want_count(v);
+		bad += int_slice_index_of(ints, v) != want_index(v);
+
+		snprintf(key, sizeof(key), "k%d", v);
+		bad += !string_slice_contains(strings, key);
+		bad += string_slice_count(strings, key, NULL) != want_count(v);
+	}
+	bad += int_slice_contains(ints, DISTINCT);
+	bad += string_slice_contains(strings, "missing");
+
+	return (void*)bad;
+}
+
+static void
+read_concurrently(const char *when)
+{
+	pthread_t threads[READERS];
+
+	for (int i = 0; i < READERS; i++) {
+		CHECK(pthread_create(&threads[i], NULL, read_all, NULL) == 0);
+	}
+	for (int i = 0; i < READERS; i++) {
+		void *bad;
+		CHECK(pthread_join(threads[i], &bad) == 0);
+		if ((uintptr_t)bad != 0) {
+			fprintf(stderr, "FAIL %s: %lu wrong answers\n", when, (unsigned long)(uintptr_t)bad);
+			test_failures++;
+		}
+	}
+}
+
+/**
+ * shift_items adds *user_data to every item. Run through a view, which the
+ * slice can't see, it leaves the index answering for the old items, so a
+ * count that differs from a scan shows the index was used.
+ */
+static void
+shift_items(int *items, const uint64_t n, void *user_data)
+{
+	const int by = *(const int *)user_data;
+
+	for (uint64_t i = 0; i < n; i++) {
+		items[i] += by;
+	}
+}
+
+static bool
+int_index_used(void)
+{
+	int by = 10 * DISTINCT;
+	int_slice_view_t v = int_slice_as_view(ints);
+
+	int_slice_view_transform(v, shift_items, &by);
+	bool used = int_slice_count(ints, 1, NULL) != 0;
+	by = -by;
+	int_slice_view_transform(v, shift_items, &by);
+
+	return used;
+}
+
+static bool
+string_index_used(void)
+{
+	return slice_index_live(strings->index);
+}
+
+static bool
+int_eq(const int x, const int y, void *user_data)
+{
+	(void)user_data;
+
+	return x == y;
+}
+
+static bool
+string_eq(const char *x, const char *y, void *user_data)
+{
+	(void)user_data;
+
+	return strcmp(x, y) == 0;
+}
+
+static bool
+int_keep(const int item, void *user_data)
+{
+	(void)user_data;
+
+	return item % 7 != 3;
+}
+
+static bool
+string_keep(const char *item, void *user_data)
+{
+	(void)user_data;
+
+	return item[strlen(item) - 1] != '3';
+}
+
+/**
+ * check_against_scan compares what the indexes say about every value with
+ * a count that scans, a compare function keeping count off the index.
+ */
+static void
+check_against_scan(const char *after)
+{
+	char key[16];
+	uint64_t bad = 0;
+
+	for (int v = -1; v <= DISTINCT + 2; v++) {
+		bad += int_slice_count(ints, v, NULL) != int_slice_count(ints, v, int_eq);
+		bad += int_slice_contains(ints, v) != (int_slice_count(ints, v, int_eq) != 0);
+
+		snprintf(key, sizeof(key), "k%d", v);
+		bad += string_slice_count(strings, key, NULL) != string_slice_count(strings, key, string_eq);
+	}
+	if (bad != 0) {
+		fprintf(stderr, "FAIL after %s: %lu wrong answers\n", after, (unsigned long)bad);
+		test_failures++;
+	}
+	CHECK(int_index_used());
+	CHECK(string_index_used());
+}
+
+int
+main(void)
+{
+	char key[16];
+
+	ints = int_slice_new(DISTINCT * REPEATS);
+	strings = string_slice_new(DISTINCT * REPEATS);
+	CHECK(ints != NULL && strings != NULL);
+
+	for (int r = 0; r < REPEATS; r++) {
+		for (int v = 0; v < DISTINCT; v++) {
+			int_slice_append(ints, v);
+			snprintf(key, sizeof(key), "k%d", v);
+			string_slice_append(strings, key);
+		}
+	}
+
+	CHECK(int_slice_index_build(ints) == -1);
+	CHECK(string_slice_index_build(strings) == -1);
+	CHECK(int_slice_index_enable(ints) == 0);
+	CHECK(string_slice_index_enable(strings) == 0);
+	CHECK(int_slice_index_bytes(ints) > 0);
+	CHECK(string_slice_index_bytes(strings) > 0);
+
+	/**
+	 * the deletes update both indexes in place, so the queries after them
+	 * still use the index, without a call to index_build.
+	 */
+	int_slice_delete(ints, 0);
+	string_slice_delete(strings, 0);
+	CHECK(int_index_used());
+	CHECK(string_index_used());
+	read_concurrently("delete");
+
+	/**
+	 * a stale index is left alone by queries, which search the items.
+	 */
+	int_slice_index_invalidate(ints);
+	string_slice_index_invalidate(strings);
+	CHECK(!int_index_used());
+	CHECK(!string_index_used());
+	read_concurrently("stale index");
+	CHECK(int_slice_index_build(ints) == 0);
+	CHECK(string_slice_index_build(strings) == 0);
+	read_concurrently("rebuilt index");
+
+	int_slice_swap_remove(ints, 5);
+	string_slice_swap_remove(strings, 5);
+	check_against_scan("swap_remove");
+
+	int_slice_replace_by_idx(ints, 10, DISTINCT + 2);
+	string_slice_replace_by_idx(strings, 10, "k1001");
+	check_against_scan("replace_by_idx");
+
+	int_slice_replace_by_val(ints, 4, 5, 30, NULL);
+	string_slice_replace_by_val(strings, "k4", "k5", 30, NULL);
+	int_slice_replace_by_val(ints, 6, 8, UINT64_MAX, NULL);
+	string_slice_replace_by_val(strings, "k6", "k8", UINT64_MAX, NULL);
+	check_against_scan("replace_by_val");
+
+	int_slice_remove_value(ints, 9);
+	string_slice_remove_value(strings, "k9");
+	check_against_scan("remove_value");
+
+	int_slice_retain(ints, int_keep, NULL);
+	string_slice_retain(strings, string_keep, NULL);
+	check_against_scan("retain");
+
+	const size_t idx[] = {0, 2, 2, 17, 400, 401};
+	int_slice_delete_indices(ints, idx, 6);
+	string_slice_delete_indices(strings, idx, 6);
+	check_against_scan("delete_indices");
+
+	int_slice_insert(ints, 3, -1);
+	string_slice_insert(strings, 3, "k-1");
+	check_against_scan("insert");
+
+	int_slice_sort(ints, NULL);
+	string_slice_sort(strings, NULL);
+	string_slice_reverse(strings);
+	check_against_scan("sort");
+
+	string_slice_shrink_to_fit(strings);
+	check_against_scan("shrink_to_fit");
+
+	int_slice_free(ints);
+	string_slice_free(strings);
+
+	return test_report("index_test");
+}
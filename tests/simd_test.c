@@ -0,0 +1,224 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../slice_simd.h"
+#include "test.h"
+
+/**
+ * every kernel is run on each length up to MAX_LEN, which crosses the
+ * 4 vector main loop of the widest kernels, starting at each of OFFSETS
+ * items past a 64 byte boundary so the vector loads are unaligned.
+ */
+#define MAX_LEN 130
+#define OFFSETS 8
+#define BUF_SIZE ((MAX_LEN + OFFSETS) * sizeof(uint64_t))
+
+enum pattern {
+	PATTERN_SPREAD,
+	PATTERN_FEW,
+	PATTERN_SINGLE,
+	PATTERN_COUNT
+};
+
+static const char *pattern_names[PATTERN_COUNT] = {
+	"spread", "few values", "single match"
+};
+
+static const char *level_names[] = {
+	"scalar", "sse2", "avx2", "avx512"
+};
+
+/**
+ * results holds what each kernel returned for one input, the items left
+ * by remove are kept apart in a buffer.
+ */
+typedef struct {
+	size_t find;
+	size_t count;
+	size_t left;
+	uint64_t sum;
+	unsigned char min[8];
+	unsigned char max[8];
+} results_t;
+
+static _Alignas(64) unsigned char items[BUF_SIZE];
+static _Alignas(64) unsigned char want_left[BUF_SIZE];
+static _Alignas(64) unsigned char got_left[BUF_SIZE];
+
+static uint64_t rand_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t
+test_rand(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+
+	return rand_state;
+}
+
+static void
+set_item(unsigned char *p, const size_t i, const size_t width, const uint64_t v)
+{
+	switch (width) {
+	case 1:
+		((uint8_t *)p)[i] = (uint8_t)v;
+		break;
+	case 2:
+		((uint16_t *)p)[i] = (uint16_t)v;
+		break;
+	case 4:
+		((uint32_t *)p)[i] = (uint32_t)v;
+		break;
+	default:
+		((uint64_t *)p)[i] = v;
+		break;
+	}
+}
+
+static uint64_t
+get_item(const unsigned char *p, const size_t i, const size_t width)
+{
+	switch (width) {
+	case 1:
+		return ((const uint8_t *)p)[i];
+	case 2:
+		return ((const uint16_t *)p)[i];
+	case 4:
+		return ((const uint32_t *)p)[i];
+	default:
+		return ((const uint64_t *)p)[i];
+	}
+}
+
+/**
+ * fill writes n items of a pattern at p and returns the value to search
+ * for. PATTERN_FEW draws from 3 values and sometimes searches for a 4th,
+ * PATTERN_SINGLE has one match at a random position.
+ */
+static uint64_t
+fill(unsigned char *p, const size_t n, const size_t width, enum pattern pat)
+{
+	for (size_t i = 0; i < n; i++) {
+		switch (pat) {
+		case PATTERN_FEW:
+			set_item(p, i, width, test_rand() % 3);
+			break;
+		case PATTERN_SINGLE:
+			set_item(p, i, width, 0);
+			break;
+		default:
+			set_item(p, i, width, test_rand());
+			break;
+		}
+	}
+
+	switch (pat) {
+	case PATTERN_FEW:
+		return test_rand() % 4;
+	case PATTERN_SINGLE:
+		if (n > 0) {
+			set_item(p, test_rand() % n, width, 1);
+		}
+		return 1;
+	default:
+		if (n > 0 && test_rand() % 2 == 0) {
+			return get_item(p, test_rand() % n, width);
+		}
+		return test_rand();
+	}
+}
+
+/**
+ * run calls every kernel in use on the n items at p and stores what they
+ * return in r, remove working on a copy of the items in left.
+ */
+static void
+run(const unsigned char *p, const size_t n, const size_t width, const bool is_signed, const uint64_t val,
+    unsigned char *left, results_t *r)
+{
+	memset(r, 0, sizeof(*r));
+
+	r->find = slice_simd_find(p, n, width, val);
+	r->count = slice_simd_count(p, n, width, val);
+	r->sum = slice_simd_sum(p, n, width, is_signed);
+	if (n > 0) {
+		slice_simd_minmax(p, n, width, is_signed, r->min, r->max);
+	}
+
+	memcpy(left, p, width * n);
+	r->left = slice_simd_remove(left, n, width, val);
+}
+
+static void
+report(const char *op, slice_simd_level_t level, const size_t width, const bool is_signed,
+    enum pattern pat, const size_t n, const size_t off)
+{
+	fprintf(stderr, "FAIL %s %s: %s%zu, %s, n = %zu, offset %zu\n", level_names[level], op,
+	    is_signed ? "i" : "u", 8 * width, pattern_names[pat], n, off);
+	test_failures++;
+}
+
+/**
+ * check_level compares every kernel of the given level with the scalar
+ * kernel on the same input.
+ */
+static void
+check_level(slice_simd_level_t level, const size_t width, const bool is_signed)
+{
+	results_t want, got;
+
+	for (unsigned pat = 0; pat < PATTERN_COUNT; pat++) {
+		for (size_t n = 0; n <= MAX_LEN; n++) {
+			for (size_t off = 0; off < OFFSETS; off++) {
+				unsigned char *p = items + off * width;
+				const uint64_t val = fill(p, n, width, pat);
+
+				slice_simd_use(SLICE_SIMD_SCALAR);
+				run(p, n, width, is_signed, val, want_left + off * width, &want);
+				slice_simd_use(level);
+				run(p, n, width, is_signed, val, got_left + off * width, &got);
+
+				if (got.find != want.find) {
+					report("find", level, width, is_signed, pat, n, off);
+				}
+				if (got.count != want.count) {
+					report("count", level, width, is_signed, pat, n, off);
+				}
+				if (got.sum != want.sum) {
+					report("sum", level, width, is_signed, pat, n, off);
+				}
+				if (memcmp(got.min, want.min, width) != 0 || memcmp(got.max, want.max, width) != 0) {
+					report("minmax", level, width, is_signed, pat, n, off);
+				}
+				if (got.left != want.left ||
+				    memcmp(got_left + off * width, want_left + off * width, width * want.left) != 0) {
+					report("remove", level, width, is_signed, pat, n, off);
+				}
+			}
+		}
+	}
+}
+
+int
+main(void)
+{
+	static const size_t widths[] = {1, 2, 4, 8};
+
+	for (slice_simd_level_t level = SLICE_SIMD_SSE2; level <= SLICE_SIMD_AVX512; level++) {
+		if (slice_simd_use(level) != level) {
+			printf("simd_test: no %s, skipped\n", level_names[level]);
+			continue;
+		}
+		for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++) {
+			check_level(level, widths[w], false);
+			check_level(level, widths[w], true);
+		}
+	}
+	slice_simd_use(SLICE_SIMD_AVX512);
+
+	return test_report("simd_test");
+}
@@ -0,0 +1,212 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../int32_slice.h"
+#include "../slice_allocator.h"
+#include "../slice_sort.h"
+#include "test.h"
+
+/**
+ * sizes straddle the insertion sort cutoff (16) and the radix cutoff (256)
+ * so the introsort, the radix sort and the boundaries between them all
+ * get compared against qsort.
+ */
+static const size_t sizes[] = {
+	0, 1, 2, 3, 15, 16, 17, 33, 100, 255, 256, 257, 1000, 4099, 70000
+};
+
+#define SIZE_COUNT (sizeof(sizes) / sizeof(sizes[0]))
+#define SIZE_MAX_TESTED 70000
+
+enum pattern {
+	PATTERN_RANDOM,
+	PATTERN_EQUAL,
+	PATTERN_NEGATIVE,
+	PATTERN_SORTED,
+	PATTERN_REVERSED,
+	PATTERN_SMALL,
+	PATTERN_TOP,
+	PATTERN_COUNT
+};
+
+static const char *pattern_names[PATTERN_COUNT] = {
+	"random", "all equal", "negative heavy", "sorted", "reversed",
+	"small values", "top byte only"
+};
+
+static uint64_t rand_state = 0x9e3779b97f4a7c15ULL;
+
+/**
+ * the sorts take their scratch buffers from a counting allocator, so the
+ * test can tell that the radix sort uses the allocator it's given.
+ */
+static uint64_t alloc_count;
+static uint64_t free_count;
+
+static void*
+count_alloc(void *ctx, size_t size)
+{
+	(void)ctx;
+	alloc_count++;
+
+	return malloc(size);
+}
+
+static void*
+count_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+	(void)ctx;
+	(void)old_size;
+	alloc_count++;
+
+	return realloc(ptr, new_size);
+}
+
+static void
+count_free(void *ctx, void *ptr)
+{
+	(void)ctx;
+	free_count++;
+	free(ptr);
+}
+
+static const slice_allocator_t counting = {
+	count_alloc, count_realloc, count_free, NULL
+};
+
+static uint64_t
+test_rand(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+
+	return rand_state;
+}
+
+/**
+ * pattern_value returns the i'th of n raw values of a pattern, truncated
+ * to the item width by the caller. PATTERN_SMALL keeps every byte above the
+ * lowest uniform so the radix sort skips those passes, PATTERN_TOP does
+ * the reverse and varies only the top byte.
+ */
+static uint64_t
+pattern_value(enum pattern p, size_t i, size_t n, size_t width)
+{
+	uint64_t r = test_rand();
+
+	switch (p) {
+	case PATTERN_EQUAL:
+		return 0xa5a5a5a5a5a5a5a5ULL;
+	case PATTERN_NEGATIVE:
+		if (r % 10 == 0) {
+			return r % 100;
+		}
+		return (uint64_t)-(int64_t)(r % 100 + 1);
+	case PATTERN_SORTED:
+		return i;
+	case PATTERN_REVERSED:
+		return n - 1 - i;
+	case PATTERN_SMALL:
+		return r % 200;
+	case PATTERN_TOP:
+		return (r & 0xff) << (8 * width - 8);
+	default:
+		return r;
+	}
+}
+
+/**
+ * SORT_TEST defines check_<suffix>, which fills a buffer of T with each
+ * pattern at each size, sorts one copy with slice_sort and another with
+ * qsort and reports any difference. Inputs long enough for the radix sort
+ * of wider items have to allocate and free exactly one scratch buffer.
+ */
+#define SORT_TEST(suffix, T, is_signed)                                          \
+static int                                                                       \
+cmp_##suffix(const void *a, const void *b)                                       \
+{                                                                                \
+	T x = *(const T *)a, y = *(const T *)b;                                  \
+	return (x > y) - (x < y);                                                \
+}                                                                                \
+                                                                                 \
+static void                                                                      \
+check_##suffix(T *got, T *want)                                                  \
+{                                                                                \
+	for (unsigned p = 0; p < PATTERN_COUNT; p++) {                           \
+		for (size_t k = 0; k < SIZE_COUNT; k++) {                        \
+			size_t n = sizes[k];                                     \
+			                                                         \
+			for (size_t i = 0; i < n; i++) {                         \
+				want[i] = (T)pattern_value(p, i, n, sizeof(T));  \
+			}                                                        \
+			memcpy(got, want, sizeof(T) * n);                        \
+			                                                         \
+			const uint64_t allocs = alloc_count;                     \
+			slice_sort(got, n, sizeof(T), is_signed, &counting);     \
+			CHECK(alloc_count - allocs ==                            \
+			    (sizeof(T) > 1 && n >= 256 ? 1u : 0u));              \
+			CHECK(free_count == alloc_count);                        \
+			qsort(want, n, sizeof(T), cmp_##suffix);                 \
+			                                                         \
+			if (memcmp(got, want, sizeof(T) * n) != 0) {             \
+				fprintf(stderr, "FAIL %s: %s, n = %zu\n",        \
+				    #T, pattern_names[p], n);                    \
+				test_failures++;                                 \
+			}                                                        \
+		}                                                                \
+	}                                                                        \
+}
+
+SORT_TEST(i8, int8_t, true)
+SORT_TEST(u8, uint8_t, false)
+SORT_TEST(i16, int16_t, true)
+SORT_TEST(u16, uint16_t, false)
+SORT_TEST(i32, int32_t, true)
+SORT_TEST(u32, uint32_t, false)
+SORT_TEST(i64, int64_t, true)
+SORT_TEST(u64, uint64_t, false)
+
+int
+main(void)
+{
+	uint64_t *got = malloc(sizeof(uint64_t) * SIZE_MAX_TESTED);
+	uint64_t *want = malloc(sizeof(uint64_t) * SIZE_MAX_TESTED);
+	if (got == NULL || want == NULL) {
+		fprintf(stderr, "FAIL: out of memory\n");
+		return 1;
+	}
+
+	check_i8((int8_t *)got, (int8_t *)want);
+	check_u8((uint8_t *)got, (uint8_t *)want);
+	check_i16((int16_t *)got, (int16_t *)want);
+	check_u16((uint16_t *)got, (uint16_t *)want);
+	check_i32((int32_t *)got, (int32_t *)want);
+	check_u32((uint32_t *)got, (uint32_t *)want);
+	check_i64((int64_t *)got, (int64_t *)want);
+	check_u64((uint64_t *)got, (uint64_t *)want);
+
+	free(got);
+	free(want);
+
+	/**
+	 * a slice sorts with its own allocator.
+	 */
+	int32_slice_t *s = int32_slice_new_with_allocator(1024, &counting);
+	CHECK(s != NULL);
+	for (int32_t i = 0; i < 1024; i++) {
+		int32_slice_append(s, 1024 - i);
+	}
+	const uint64_t allocs = alloc_count;
+	int32_slice_sort(s, NULL);
+	CHECK(alloc_count - allocs == 1);
+	CHECK(int32_slice_get(s, 0) == 1 && int32_slice_get(s, 1023) == 1024);
+	int32_slice_free(s);
+	CHECK(free_count == alloc_count);
+
+	return test_report("sort_test");
+}
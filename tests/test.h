@@ -0,0 +1,40 @@
+#ifndef __TEST_H
+#define __TEST_H
+
+#include <stdio.h>
+
+/**
+ * test_failures counts the failed checks of a test program. Each program
+ * is a single source file, so every one gets its own count.
+ */
+static int test_failures;
+
+/**
+ * CHECK counts a failure, and reports it with its file and line, if cond
+ * doesn't hold.
+ */
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            test_failures++;                                                     \
+        }                                                                        \
+    } while (0)
+
+/**
+ * test_report prints the outcome of the named test program and returns
+ * its exit status, for main to return.
+ */
+static inline int
+test_report(const char *name)
+{
+    if (test_failures > 0) {
+        fprintf(stderr, "%s: %d failures\n", name, test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+
+    return 0;
+}
+
+#endif /** end __TEST_H */